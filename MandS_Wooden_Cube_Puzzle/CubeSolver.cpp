@@ -1,57 +1,549 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
 #include <vector>
-#include <cmath> // pow()
 
 #include "cubeSolver.h"
 #include "wrappedPiece.h"
+#include "workStealingPool.h"
 
-cubeSolver::cubeSolver() {
-	std::vector<int> row(SIZE);
-	std::vector<std::vector<int> > mat(SIZE, row);
-	grid.insert(grid.begin(), SIZE, mat);
+// Swallows all output when the solver is not verbose
+static std::ostream silent(0);
 
-	count = 0;
+// Constructor taking in the size of the box, by default a 3 x 3 x 3 cube
+cubeSolver::cubeSolver(const boxDimensions &dimensions) : box(dimensions) {
+	kernels = selectKernels(box);
+	grid = 0;
+	lastProgressSeconds = 0;
+	clockCountdown = nodesPerClockCheck;
+	clockPeriod = nodesPerClockCheck;
+	clockedNodes = 0;
+	deadlineSeconds = 0;
+	nodeLimit = 0;
+	cancelToken = 0;
+	sharedNodes = 0;
+	aborted = false;
+	status = exhaustedStatus;
+	checkpointSeconds = 60;
+	resume = false;
+	checkpointing = false;
+	lastCheckpointSeconds = 0;
+	resumeDepth = -1;
+	mode = interleavedSearch;
+	activeMode = interleavedSearch;
+	symmetryBreaking = false;
+	anchorLevel = 0;
+	checkUniqueness = false;
+	boxAnalysed = false;
+	regionPruning = true;
+	pruneRegions = false;
+	colourPruning = true;
+	pruneColours = false;
+	useTable = false;
+	table = 0;
+	solved = false;
+	threads = 1;
+	splitDepth = 2;
+	shardIndex = 0;
+	shardCount = 1;
+	shardLevels = 0;
+	shardTasks = 0;
+	stopFlag = 0;
+	enumerateAll = false;
+	sink = 0;
+	sinkLock = 0;
+	solutionCount = 0;
+	completions = 0;
+	firstSolutionSeconds = -1;
+	verbose = true;
+}
+
+// Forget all pieces so that another puzzle can be solved in a box of the
+// given size. The search options and memory already allocated are kept.
+cubeSolver& cubeSolver::reset(const boxDimensions &dimensions) {
+	// Puzzles of the same size keep everything worked out for the box
+	if (dimensions.get(0) != box.get(0) || dimensions.get(1) != box.get(1) || dimensions.get(2) != box.get(2)) {
+		box = dimensions;
+		kernels = selectKernels(box);
+		boxAnalysed = false;
+	}
+	wrappedPieces.clear();
+	placedMasks.clear();
+	grid = 0;
+	stats.reset(0);
+	solved = false;
+	solutionCount = 0;
+	return *this;
 }
 
 // Inform the cube of a puzzle piece
 cubeSolver& cubeSolver::addPiece(const piece &toAdd) {
-	wrappedPieces.push_back(wrappedPiece(toAdd));
+	wrappedPieces.push_back(wrappedPiece(toAdd, box));
+	placedMasks.push_back(0);
+	return *this;
+}
+
+// Select how solve() searches, interleavedSearch by default
+cubeSolver& cubeSolver::setSearchMode(searchMode toUse) {
+	mode = toUse;
+	return *this;
+}
+
+// Only search for solutions which are distinct under rotation of the
+// whole cube by restricting the placements of the given anchor piece.
+// Rotated copies which leave the anchor where it is are then dropped as
+// they are found. Off by default.
+cubeSolver& cubeSolver::setSymmetryBreaking(bool enabled, int anchor) {
+	symmetryBreaking = enabled;
+	anchorLevel = anchor;
+	return *this;
+}
+
+// Only check whether the puzzle has a unique solution up to rotation of
+// the whole box, stopping as soon as a second distinct solution is found.
+// Solutions differing only by swapping identical pieces are the same.
+// Breaks symmetry as setSymmetryBreaking() does. Off by default.
+cubeSolver& cubeSolver::setUniquenessCheck(bool enabled) {
+	checkUniqueness = enabled;
+	return *this;
+}
+
+// Solve on several threads. The interleaved search is split into one task
+// per way of placing the first splitDepth pieces and the tasks are shared
+// out by a work-stealing pool. A single thread by default.
+cubeSolver& cubeSolver::setThreads(int noOfThreads, int depth) {
+	threads = noOfThreads < 1 ? 1 : noOfThreads;
+	splitDepth = depth < 1 ? 1 : depth;
+	return *this;
+}
+
+// Search only one shard, index 0 to count - 1, of count disjoint shards.
+// Every way of placing the first splitDepth pieces (see setThreads()),
+// or for the reference search of orientating them, goes to one shard
+// in turn. Together the shards of a puzzle solved with the same options
+// search exactly what a single search would, in separate processes or
+// on separate machines. A single shard by default.
+cubeSolver& cubeSolver::setShard(int index, int count) {
+	shardCount = count < 1 ? 1 : count;
+	shardIndex = index < 0 || index >= shardCount ? 0 : index;
+	return *this;
+}
+
+// Find every solution rather than stopping at the first. Each one is
+// passed to the sink as soon as it is found, or only counted when the
+// sink is null. Off by default.
+cubeSolver& cubeSolver::setEnumerateAll(bool enabled, solutionSink *toUse) {
+	enumerateAll = enabled;
+	sink = toUse;
+	return *this;
+}
+
+// Abandon placements leaving an empty region whose size no subset of
+// the remaining pieces adds up to. Only applies when the pieces fill
+// the box exactly. On by default.
+cubeSolver& cubeSolver::setRegionPruning(bool enabled) {
+	regionPruning = enabled;
+	return *this;
+}
+
+// Abandon placements after which the remaining pieces can no longer
+// cover the marked positions of a colouring of the box, e.g. the black
+// positions of a checkerboard, and do not search at all when they never
+// can. Only applies when the pieces fill the box exactly. On by default.
+cubeSolver& cubeSolver::setColourPruning(bool enabled) {
+	colourPruning = enabled;
+	return *this;
+}
+
+// Cut off states of the grid and remaining pieces which an earlier order
+// of placements already proved have no completion, remembering them in a
+// table of 2^bits slots. Off by default.
+cubeSolver& cubeSolver::setTranspositionTable(bool enabled, int bits, transpositionTable::replacementPolicy policy) {
+	useTable = enabled;
+	failedStates.configure(bits, policy);
+	return *this;
+}
+
+// Save the search position to the file every interval seconds and once
+// more when the search ends. Only single threaded searches are saved.
+// Off by default, as is an empty file name.
+cubeSolver& cubeSolver::setCheckpoint(const std::string &file, double seconds) {
+	checkpointFile = file;
+	checkpointSeconds = seconds;
+	return *this;
+}
+
+// Carry on from the position saved in the checkpoint file, if there is
+// one, rather than starting again. The puzzle and search options must be
+// those of the run which saved it. Solutions found between the last save
+// and the interruption are found, and passed to the sink, again.
+cubeSolver& cubeSolver::setResume(bool enabled) {
+	resume = enabled;
+	return *this;
+}
+
+// Give up once solve() has run for the given seconds, leaving the
+// statistics of the search so far. 0 for no deadline, the default.
+cubeSolver& cubeSolver::setDeadline(double seconds) {
+	deadlineSeconds = seconds < 0 ? 0 : seconds;
+	return *this;
+}
+
+// Give up after visiting the given number of nodes, 0 for no limit (the
+// default). Parallel workers may overrun it by a few thousand nodes each.
+cubeSolver& cubeSolver::setNodeLimit(long long int nodes) {
+	nodeLimit = nodes < 0 ? 0 : nodes;
+	return *this;
+}
+
+// Give up as soon as another thread sets the flag, which is only read.
+// Null for none, the default.
+cubeSolver& cubeSolver::setCancelToken(std::atomic<bool> *token) {
+	cancelToken = token;
 	return *this;
 }
 
 // Solve the puzzle. Call this after adding all puzzle pieces.
-void cubeSolver::solve() {
+// Returns why the search ended.
+cubeSolver::solveStatus cubeSolver::solve() {
+	bool balanced = prepareSearch();
+	searchMode active = activeMode;
+
+	table = 0;
+	if (useTable) {
+		if ((int)wrappedPieces.size() > transpositionTable::maxPieces) {
+			log() << "Too many pieces for the transposition table, searching without it." << std::endl;
+		}
+		else if (active == referenceSearch) {
+			log() << "The reference search does not use the transposition table." << std::endl;
+		}
+		else {
+			failedStates.clear();
+			table = &failedStates;
+		}
+	}
+
+	// The table is only used beneath the levels dealt out to shards, as
+	// the subtrees of other shards' tasks are never searched
+	shardLevels = 0;
+	shardTasks = 0;
+	if (shardCount > 1) {
+		int depth = splitDepth < (int)wrappedPieces.size() ? splitDepth : (int)wrappedPieces.size() - 1;
+		shardLevels = depth < 1 ? 1 : depth;
+		log() << "Searching shard [" << shardIndex << "] of [" << shardCount << "], dealing out the ways of "
+			<< (active == referenceSearch ? "orientating" : "placing") << " the first [" << shardLevels << "] pieces" << std::endl;
+	}
 
+	checkpointing = !checkpointFile.empty();
+	if (checkpointing && shardLevels > 0) {
+		log() << "Sharded searches do not save checkpoints." << std::endl;
+		checkpointing = false;
+	}
+	else if (checkpointing && checkUniqueness) {
+		log() << "The uniqueness check does not save checkpoints." << std::endl;
+		checkpointing = false;
+	}
+	bool parallel = threads > 1 && active == interleavedSearch && !checkpointing && !checkUniqueness;
+	if (threads > 1 && active != interleavedSearch) {
+		log() << "Only the interleaved search runs in parallel, using a single thread." << std::endl;
+	}
+	else if (threads > 1 && checkUniqueness) {
+		log() << "The uniqueness check runs on a single thread." << std::endl;
+	}
+	else if (threads > 1 && checkpointing) {
+		log() << "Only single threaded searches save checkpoints, using a single thread." << std::endl;
+	}
+
+	cursor.assign(wrappedPieces.size(), 0);
+	resumeDepth = -1;
+	lastCheckpointSeconds = 0;
+
+	bool finished = false;
+	if (checkpointing && resume) {
+		searchCheckpoint saved;
+		if (saved.load(checkpointFile)) {
+			if (saved.fingerprint != fingerprint()) {
+				throw std::runtime_error("Checkpoint [" + checkpointFile + "] was saved for another puzzle or other search options");
+			}
+			finished = restoreCheckpoint(saved);
+			log() << "Resuming from [" << checkpointFile << "] after [" << saved.elapsedSeconds << "s]";
+			if (finished) {
+				log() << ", which had already finished";
+			}
+			log() << std::endl;
+		}
+	}
+
+	if (finished || !balanced) {
+		// Nothing left to search
+	}
+	else if (active == referenceSearch) {
+		outerSolver(0, finished); // Set outerLevel = 0
+	}
+	else if (active == constrainedSearch) {
+		buildCandidates();
+		constrainedSolver(0, finished); // Set depth = 0
+	}
+	else if (parallel) {
+		parallelSolver(finished);
+	}
+	else {
+		interleavedSolver(0, finished); // Set level = 0
+	}
+
+	// A search which gave up saved its checkpoint where it stopped
+	if (checkpointing && !aborted) {
+		saveCheckpoint(0, true);
+	}
+
+	if (!aborted) {
+		status = solutionCount > 0 || solved ? solvedStatus : exhaustedStatus;
+	}
+	else {
+		log() << "Search stopped early: [" << statusName(status) << "], the statistics below are partial" << std::endl;
+	}
+
+	if (verbose) {
+		stats.printDepths(log());
+	}
+
+	if (table != 0) {
+		long long int lookups = stats.totalTableHits() + stats.totalTableMisses();
+		log() << "Transposition table: [" << table->noOfUsedSlots() << "] of [" << table->noOfSlots()
+			<< "] slots used, [" << stats.totalTableHits() << "] hits from [" << lookups << "] lookups";
+		if (lookups > 0) {
+			log() << " ([" << 100.0 * (double)stats.totalTableHits() / (double)lookups << "%])";
+		}
+		log() << std::endl;
+	}
+
+	if (checkUniqueness) {
+		log() << "Distinct solutions found: [" << distinctSolutions.size() << "]"
+			<< (distinctSolutions.size() == 1 ? ", the solution is unique" : "") << std::endl;
+	}
+
+	if (enumerateAll) {
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+		log() << "Solutions found: [" << solutionCount << "]" << std::endl;
+		log() << "Search time: [" << seconds << "s]" << std::endl;
+		if (firstSolutionSeconds >= 0) {
+			log() << "Time to first solution: [" << firstSolutionSeconds << "s]" << std::endl;
+		}
+		if (seconds > 0) {
+			log() << "Solutions per second: [" << (double)solutionCount / seconds << "]" << std::endl;
+		}
+	}
+
+	return status;
+}
+
+// Builds everything the search needs and empties the grid and counters,
+// choosing activeMode. Returns false if no solution can exist.
+bool cubeSolver::prepareSearch() {
 	// Retrieve the number of shifts/locations each piece permits
 	long long int totalLocationPermutations = 1;
-	std::cout << "Shifts/locations per piece: ";
+	noOfLocations.clear();
+	log() << "Shifts/locations per piece: ";
 	for (int i = 0; i < (int)wrappedPieces.size(); ++i) {
 		int locations = wrappedPieces[i].noOfLocations();
-		std::cout << "[" << locations << "] ";
+		log() << "[" << locations << "] ";
 
 		noOfLocations.push_back(locations);
 
 		totalLocationPermutations *= locations;
 	}
-	std::cout << std::endl << std::endl;
+	log() << std::endl;
 
-	std::cout << "Total shifts/locations permutations: [" << totalLocationPermutations << "]" << std::endl;
-	std::cout << "Total orientation permutations: [" << pow(24, (int)wrappedPieces.size()) << "]" << std::endl;
-	std::cout << "The total possible combinations/iterations will be the PRODUCT of the above two numbers." << std::endl;
-	std::cout << "However note that if one solution exists, then 24 solutions necessarily exist by " << std::endl;
-	std::cout << "re-orientating and rotating the first solution." << std::endl << std::endl;
+	// Symmetric pieces have fewer than 24 distinct orientations
+	double totalOrientationPermutations = 1;
+	log() << "Distinct orientations per piece (duplicates removed): ";
+	for (int i = 0; i < (int)wrappedPieces.size(); ++i) {
+		log() << "[" << wrappedPieces[i].noOfOrientations() << " ("
+			<< wrappedPieces[i].noOfDuplicateOrientations() << ")] ";
 
-	bool finished = false;
-	outerSolver(0, finished); // Set outerLevel = 0
+		totalOrientationPermutations *= wrappedPieces[i].noOfOrientations();
+	}
+	log() << std::endl << std::endl;
+
+	// Enumerate every placement up front so that the search itself
+	// never has to rotate or shift a piece
+	placements.build(wrappedPieces, box);
+	currentOrientations.assign(wrappedPieces.size(), 0);
+
+	if (!boxAnalysed) {
+		analyseBox();
+	}
+
+	if ((symmetryBreaking || checkUniqueness) && !wrappedPieces.empty()) {
+		if (anchorLevel < 0 || anchorLevel >= (int)wrappedPieces.size()) {
+			throw std::invalid_argument("The anchor piece must be one of the [" + std::to_string(wrappedPieces.size()) + "] pieces added");
+		}
+		int before = placements.noOfPlacements(anchorLevel);
+		placements.keepCanonicalPlacements(anchorLevel);
+		log() << "Symmetry breaking: piece [" << (anchorLevel + 1) << "] keeps ["
+			<< placements.noOfPlacements(anchorLevel) << "] of [" << before << "] placements" << std::endl;
+	}
+
+	log() << "Total shifts/locations permutations: [" << totalLocationPermutations << "]" << std::endl;
+	log() << "Total orientation permutations: [" << totalOrientationPermutations << "]" << std::endl;
+	log() << "The total possible combinations/iterations will be the PRODUCT of the above two numbers." << std::endl;
+	log() << "However note that the box maps onto itself under [" << boxSymmetries.size() << "] rotations (including none), " << std::endl;
+	log() << "so if one solution exists up to that many exist by rotating the first solution";
+	if (symmetryBreaking || checkUniqueness) {
+		log() << ", only one of which is searched for";
+	}
+	log() << "." << std::endl << std::endl;
+	log() << "Overlap tests use [" << instructionSetName(kernels.fitMasksInstructions) << "] instructions" << std::endl;
+
+	clearGrid();
+	solved = false;
+	stats.reset((int)wrappedPieces.size());
+	lastProgressSeconds = 0;
+	aborted = false;
+	clockedNodes = 0;
+	clockPeriod = nextClockPeriod();
+	clockCountdown = clockPeriod;
+	solutionCount = 0;
+	completions = 0;
+	distinctSolutions.clear();
+	firstSolutionSeconds = -1;
+	startTime = std::chrono::steady_clock::now();
+	callStartTime = startTime;
+
+	// Without filling the cube some positions stay empty, so a position no
+	// placement can cover is no reason to backtrack
+	int volume = 0;
+	for (int i = 0; i < (int)wrappedPieces.size(); ++i) {
+		volume += wrappedPieces[i].size();
+	}
+	searchMode active = mode;
+	if (active == constrainedSearch && volume != box.cells()) {
+		log() << "The pieces do not fill the cube, using interleaved search instead." << std::endl;
+		active = interleavedSearch;
+	}
+
+	// Equally an empty region is only a dead end when it must be filled
+	pruneRegions = regionPruning && volume == box.cells();
+	buildFillableSizes();
+
+	// As must every colouring's marked positions, which may rule out every
+	// solution before searching at all. The reference search never prunes.
+	bool balanced = true;
+	pruneColours = false;
+	colourings.clear();
+	if (colourPruning && volume == box.cells()) {
+		balanced = buildColourings();
+		pruneColours = balanced && !colourings.empty() && active != referenceSearch;
+	}
+	if (pruneColours) {
+		log() << "Colourings checked whilst searching:";
+		for (int k = 0; k < (int)colourings.size(); ++k) {
+			log() << " [" << colouringNames[k] << "]";
+		}
+		log() << std::endl;
+	}
+
+	if (wrappedPieces.empty()) {
+		log() << "No pieces have been added, there is nothing to search." << std::endl;
+		balanced = false;
+	}
+
+	activeMode = active;
+	return balanced;
+}
+
+// Print progress and statistics to std::cout whilst solving, on by default
+cubeSolver& cubeSolver::setVerbose(bool enabled) {
+	verbose = enabled;
+	return *this;
+}
+
+// Why the last solve() ended
+cubeSolver::solveStatus cubeSolver::getStatus() const {
+	return status;
+}
+
+// A short name for a status, e.g. "timed out"
+const char *cubeSolver::statusName(solveStatus toName) {
+	switch (toName) {
+	case solvedStatus:
+		return "solved";
+	case exhaustedStatus:
+		return "exhausted";
+	case timedOutStatus:
+		return "timed out";
+	case cancelledStatus:
+		return "cancelled";
+	default:
+		return "node limit";
+	}
+}
+
+// True if the last solve() left a solution in the grid
+bool cubeSolver::isSolved() const {
+	return solved;
+}
+
+// The number of solutions found by the last solve()
+long long int cubeSolver::noOfSolutions() const {
+	return solutionCount;
+}
+
+// The number of nodes visited by the last solve()
+long long int cubeSolver::noOfIterations() const {
+	return stats.totalNodes();
+}
+
+// The per-depth counters of the last solve()
+const searchStats &cubeSolver::getStats() const {
+	return stats;
+}
+
+// The distinct solutions found by the last solve() checking uniqueness,
+// at most 2 as it stops at the second
+int cubeSolver::noOfDistinctSolutions() const {
+	return (int)distinctSolutions.size();
+}
+
+// Seconds the last solve() took to find its first solution,
+// negative if none was found
+double cubeSolver::timeToFirstSolution() const {
+	return firstSolutionSeconds;
+}
+
+// The mask each piece occupies in the solution left by the last solve()
+const std::vector<cellMask> &cubeSolver::getPlacedMasks() const {
+	return placedMasks;
+}
+
+// The depths every shard of the last solve() walks alike before dealing
+// out its tasks. Their counters are the same in every shard rather than
+// adding up to those of a single search.
+int cubeSolver::noOfSharedDepths() const {
+	// The reference search only counts the locations tried beneath
+	// each dealt out combination of orientations
+	return activeMode == referenceSearch ? 0 : shardLevels;
 }
 
 // Cycles through all orientations for every piece
 void cubeSolver::outerSolver(const int outerLevel, bool &finished) {
-	for (int orientation = 0; orientation < 24; ++orientation) {
-		wrappedPieces[outerLevel].orientatePiece(orientation);
+	// Carrying on from a checkpoint starts from the orientations it saved
+	int start = resumeDepth >= 0 ? currentOrientations[outerLevel] : 0;
+
+	for (int orientation = start; orientation < wrappedPieces[outerLevel].noOfOrientations(); ++orientation) {
+		currentOrientations[outerLevel] = orientation;
 		// Only log top level 
 		if (outerLevel == 0) {
-			std::cout << "Piece [" << (outerLevel + 1) << "] with id [" << wrappedPieces[outerLevel].getId()
-				<< "] orientation [" << orientation << "]" << std::endl;
+			log() << "Piece [" << (outerLevel + 1) << "] with id [" << wrappedPieces[outerLevel].getId()
+				<< "] orientation [" << wrappedPieces[outerLevel].getOrientation(orientation) << "]" << std::endl;
+		}
+
+		if (outerLevel == shardLevels - 1 && !dealToShard()) {
+			continue;
 		}
 
 		// If there are levels below us then call outerSolver() recursively
@@ -73,88 +565,956 @@ void cubeSolver::outerSolver(const int outerLevel, bool &finished) {
 
 // Cycles through all locations for every now orientated piece
 void cubeSolver::innerSolver(const int innerLevel, bool &finished) {
-	for (int location = 0; location < noOfLocations[innerLevel]; ++location) {
-		removePiece(wrappedPieces[innerLevel].getId());
-		if (!addPieceToGrid(wrappedPieces[innerLevel].relocatePiece(location))) {
-			incrementCount();
-			continue;
+	int orientation = currentOrientations[innerLevel];
+	int first = placements.firstPlacement(innerLevel, orientation);
+	int last = placements.lastPlacement(innerLevel, orientation);
+	const cellMask *masks = placements.getMasks(innerLevel);
+
+	bool partial;
+	int start = resumeFrom(innerLevel, partial);
+	if (!partial) {
+		visitNode(innerLevel);
+		start = first;
+	}
+	if (aborted) {
+		finished = true;
+		return;
+	}
+
+	// Test a block of up to 64 placements against the grid at once, then
+	// visit only those which fit. Placing and removing pieces beneath
+	// leaves the grid as it was, so the bitmap stays valid.
+	for (int block = first + (start - first) / 64 * 64; block < last; block += 64) {
+		int size = last - block < 64 ? last - block : 64;
+		unsigned long long fits = kernels.fitMasks(masks + block, size, grid);
+		if (block < start) {
+			fits &= ~0ULL << (start - block); // Searched before the checkpoint
+		}
+		else {
+			stats.rejection(innerLevel, size - cellCount(fits));
 		}
 
-		// If there are levels below us then call innerSolver() recursively
-		// to locate lower pieces. Otherwise we must be finished!
-		if (innerLevel + 1 < (int)wrappedPieces.size()) {
-			innerSolver(innerLevel + 1, finished);
-			if (finished) {
-				return;
+		for (; fits != 0; fits &= fits - 1) {
+			int index = block + lowestCell(fits);
+			placePiece(innerLevel, masks[index]);
+			cursor[innerLevel] = index;
+			if (!partial || index != start) {
+				stats.placement(innerLevel);
 			}
+
+			// If there are levels below us then call innerSolver() recursively
+			// to locate lower pieces. Otherwise we must be finished!
+			if (innerLevel + 1 < (int)wrappedPieces.size()) {
+				innerSolver(innerLevel + 1, finished);
+				if (finished) {
+					return;
+				}
+			}
+			else {
+				foundSolution(finished);
+				if (finished) {
+					return;
+				}
+			}
+			removePiece(innerLevel);
+			stats.backtrack(innerLevel);
+		}
+	}
+}
+
+// Cycles through all orientations and locations of one piece at a time
+void cubeSolver::interleavedSolver(const int level, bool &finished) {
+	// Another parallel worker may have found a solution already
+	if (stopFlag != 0 && stopFlag->load(std::memory_order_relaxed)) {
+		finished = true;
+		return;
+	}
+
+	bool partial;
+	int start = resumeFrom(level, partial);
+	if (!partial) {
+		visitNode(level);
+	}
+	if (aborted) {
+		finished = true;
+		return;
+	}
+
+	// The pieces from this level onwards, one bit per piece by order of addition
+	unsigned long long remaining = 0;
+	long long int completionsBefore = completions;
+	if (table != 0 && level >= shardLevels && level > 0 && !partial) {
+		remaining = ((1ULL << wrappedPieces.size()) - 1) & ~((1ULL << level) - 1);
+		bool hit = table->contains(grid, remaining);
+		stats.tableLookup(level, hit);
+		if (hit) {
+			return; // Already searched via another order of placements
+		}
+	}
+
+	int last = placements.noOfPlacements(level);
+	const cellMask *masks = placements.getMasks(level);
+	int loggedOrientation = -1;
+
+	int needed[maxColourings];
+	if (pruneColours) {
+		neededColours(needed);
+	}
+
+	// Test a block of up to 64 placements against the grid at once, then
+	// visit only those which fit. Placing and removing pieces beneath
+	// leaves the grid as it was, so the bitmap stays valid.
+	for (int block = start / 64 * 64; block < last; block += 64) {
+		int size = last - block < 64 ? last - block : 64;
+		unsigned long long fits = kernels.fitMasks(masks + block, size, grid);
+		if (block < start) {
+			fits &= ~0ULL << (start - block); // Searched before the checkpoint
 		}
 		else {
-			finished = true;
-			std::cout << "Finished!!! Please print out cube." << std::endl;
+			stats.rejection(level, size - cellCount(fits));
+		}
+
+		for (; fits != 0; fits &= fits - 1) {
+			int index = block + lowestCell(fits);
+
+			// Only log top level
+			if (level == 0 && placements.getOrientation(0, index) != loggedOrientation) {
+				loggedOrientation = placements.getOrientation(0, index);
+				log() << "Piece [" << (level + 1) << "] with id [" << wrappedPieces[level].getId()
+					<< "] orientation [" << loggedOrientation << "]" << std::endl;
+			}
+
+			placePiece(level, masks[index]);
+			cursor[level] = index;
+			if (!partial || index != start) {
+				stats.placement(level);
+			}
+
+			// The colourings are checked first as they cost a few lookups
+			// rather than a flood fill of the empty space
+			if (pruneColours && level + 1 < (int)wrappedPieces.size() && !coloursReachable(level, index, needed)) {
+				removePiece(level);
+				stats.prune(level);
+				continue;
+			}
+
+			if (pruneRegions && level + 1 < (int)wrappedPieces.size() && !regionsFillable(fillableSizes[level + 1])) {
+				removePiece(level);
+				stats.prune(level);
+				continue;
+			}
+
+			if (level == shardLevels - 1 && !dealToShard()) {
+				removePiece(level);
+				stats.backtrack(level);
+				continue;
+			}
+
+			// If there are levels below us then call interleavedSolver() recursively
+			// to place lower pieces. Otherwise we must be finished!
+			if (level + 1 < (int)wrappedPieces.size()) {
+				interleavedSolver(level + 1, finished);
+				if (finished) {
+					return;
+				}
+			}
+			else {
+				foundSolution(finished);
+				if (finished) {
+					return;
+				}
+			}
+			removePiece(level);
+			stats.backtrack(level);
+		}
+	}
+
+	// Every placement was tried without finding a solution
+	if (table != 0 && level >= shardLevels && level > 0 && !partial && completions == completionsBefore) {
+		table->insert(grid, remaining);
+	}
+}
+
+// Fills the empty position with the fewest live placements covering it
+void cubeSolver::constrainedSolver(const int depth, bool &finished) {
+	if (depth == (int)wrappedPieces.size()) {
+		foundSolution(finished);
+		return;
+	}
+
+	bool partial;
+	int start = resumeFrom(depth, partial);
+	if (!partial) {
+		visitNode(depth);
+	}
+	if (aborted) {
+		finished = true;
+		return;
+	}
+
+	// Find the most constrained empty position
+	int best = kernels.mostConstrainedCell(~grid & box.allCells(), &candidates[0], box);
+	if (candidates[best] == 0) {
+		stats.rejection(depth);
+		return; // Dead position, nothing can fill it any more
+	}
+
+	// The pieces still to be placed, one bit per piece by order of addition
+	unsigned long long remaining = 0;
+	long long int completionsBefore = completions;
+	if (table != 0 && depth >= shardLevels && depth > 0) {
+		for (int level = 0; level < (int)wrappedPieces.size(); ++level) {
+			if (placedMasks[level] == 0) {
+				remaining |= 1ULL << level;
+			}
+		}
+	}
+
+	if (table != 0 && depth >= shardLevels && depth > 0 && !partial) {
+		bool hit = table->contains(grid, remaining);
+		stats.tableLookup(depth, hit);
+		if (hit) {
+			return; // Already searched via another order of placements
+		}
+	}
+
+	if (pruneColours && depth > 0 && !remainingColoursReachable()) {
+		stats.prune(depth - 1);
+		return;
+	}
+
+	if (pruneRegions && depth > 0) {
+		cellMask sizes = 1;
+		for (int level = 0; level < (int)wrappedPieces.size(); ++level) {
+			if (placedMasks[level] == 0) {
+				sizes |= sizes << wrappedPieces[level].size();
+			}
+		}
+		if (!regionsFillable(sizes)) {
+			stats.prune(depth - 1);
+			return;
+		}
+	}
+
+	const std::vector<int> &covering = cellPlacements[best];
+	for (int i = start; i < (int)covering.size(); ++i) {
+		int id = covering[i];
+		if (!alive[id]) {
+			continue;
+		}
+
+		int level = placementLevel[id];
+		int mark = (int)killed.size();
+		addPieceToGrid(level, placementMask[id]);
+		killConflicts(id);
+		cursor[depth] = i;
+		if (!partial || i != start) {
+			stats.placement(depth);
+		}
+
+		if (depth == shardLevels - 1 && !dealToShard()) {
+			reviveSince(mark);
+			removePiece(level);
+			stats.backtrack(depth);
+			continue;
+		}
+
+		constrainedSolver(depth + 1, finished);
+		if (finished) {
 			return;
 		}
+
+		reviveSince(mark);
+		removePiece(level);
+		stats.backtrack(depth);
+	}
+
+	// Every way of filling the position failed
+	if (table != 0 && depth >= shardLevels && depth > 0 && !partial && completions == completionsBefore) {
+		table->insert(grid, remaining);
 	}
 }
 
-// Empties the entire grid of all pieces
-void cubeSolver::clearGrid() {
-	for (unsigned int z = 0; z < SIZE; ++z) {
-		for (unsigned int y = 0; y < SIZE; ++y) {
-			for (unsigned int x = 0; x < SIZE; ++x) {
-				grid[z][y][x] = 0;
+// Runs the interleaved search on a work-stealing pool of threads
+void cubeSolver::parallelSolver(bool &finished) {
+	// Clamped for this puzzle only, later puzzles get splitDepth as set
+	int depth = splitDepth < (int)wrappedPieces.size() ? splitDepth : (int)wrappedPieces.size() - 1;
+	if (depth < 1) {
+		depth = 1;
+	}
+
+	std::vector<std::vector<int> > tasks;
+	std::vector<int> prefix;
+	collectTasks(0, depth, prefix, tasks);
+
+	// Tasks are dealt out to shards in the order the single threaded search makes them
+	if (shardLevels > 0) {
+		std::vector<std::vector<int> > dealt;
+		for (int t = shardIndex; t < (int)tasks.size(); t += shardCount) {
+			dealt.push_back(tasks[t]);
+		}
+		tasks.swap(dealt);
+	}
+	log() << "Running [" << tasks.size() << "] tasks on [" << threads << "] threads" << std::endl;
+
+	// Every worker searches its own copy of the solver so that the grid
+	// and counters are never shared between threads
+	std::atomic<bool> stop(false);
+	std::atomic<long long int> nodes(0);
+	std::mutex lock;
+	std::vector<cubeSolver> workers(threads, *this);
+	workStealingPool pool(threads);
+	for (int w = 0; w < threads; ++w) {
+		workers[w].stopFlag = &stop;
+		workers[w].sharedNodes = &nodes;
+		workers[w].sinkLock = &lock;
+		workers[w].stats.reset((int)wrappedPieces.size());
+	}
+	for (int t = 0; t < (int)tasks.size(); ++t) {
+		const std::vector<int> &task = tasks[t];
+		pool.submit([&workers, &task](int worker) { workers[worker].runTask(task); });
+	}
+	pool.run();
+
+	for (int w = 0; w < threads; ++w) {
+		stats.merge(workers[w].stats);
+		solutionCount += workers[w].solutionCount;
+		if (workers[w].firstSolutionSeconds >= 0 && (firstSolutionSeconds < 0 || workers[w].firstSolutionSeconds < firstSolutionSeconds)) {
+			firstSolutionSeconds = workers[w].firstSolutionSeconds;
+		}
+		if (workers[w].solved) {
+			grid = workers[w].grid;
+			placedMasks = workers[w].placedMasks;
+			solved = true;
+		}
+		// The first worker to give up stopped the others
+		if (workers[w].aborted && !aborted) {
+			aborted = true;
+			status = workers[w].status;
+		}
+	}
+	finished = solved || aborted;
+}
+
+// Collects every non-overlapping combination of placement indices
+// for the pieces above the given depth, one per parallel task. The
+// levels above the tasks are counted here as the workers never see them.
+void cubeSolver::collectTasks(const int level, const int depth, std::vector<int> &prefix, std::vector<std::vector<int> > &tasks) {
+	if (level == depth) {
+		tasks.push_back(prefix);
+		return;
+	}
+	stats.node(level);
+
+	int needed[maxColourings];
+	if (pruneColours) {
+		neededColours(needed);
+	}
+
+	for (int index = 0; index < placements.noOfPlacements(level); ++index) {
+		if (!addPieceToGrid(level, placements.getMask(level, index))) {
+			stats.rejection(level);
+			continue;
+		}
+		stats.placement(level);
+		// Skip the prefixes the single threaded search prunes, so that both
+		// make the same tasks in the same order
+		if ((pruneColours && level + 1 < (int)wrappedPieces.size() && !coloursReachable(level, index, needed))
+			|| (pruneRegions && level + 1 < (int)wrappedPieces.size() && !regionsFillable(fillableSizes[level + 1]))) {
+			removePiece(level);
+			stats.prune(level);
+			continue;
+		}
+		prefix.push_back(index);
+		collectTasks(level + 1, depth, prefix, tasks);
+		prefix.pop_back();
+		removePiece(level);
+		stats.backtrack(level);
+	}
+}
+
+// Places a task's pieces then searches the remaining pieces
+void cubeSolver::runTask(const std::vector<int> &task) {
+	if (solved || stopFlag->load(std::memory_order_relaxed)) {
+		return;
+	}
+
+	clearGrid();
+	for (int level = 0; level < (int)task.size(); ++level) {
+		addPieceToGrid(level, placements.getMask(level, task[level]));
+	}
+
+	bool finished = false;
+	interleavedSolver((int)task.size(), finished);
+}
+
+// Called each time every piece has been placed
+void cubeSolver::foundSolution(bool &finished) {
+	++completions;
+	if (enumerateAll && symmetryBreaking && !checkUniqueness && !leastRotatedCopy()) {
+		return;
+	}
+
+	if (solutionCount++ == 0) {
+		firstSolutionSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	}
+
+	if (checkUniqueness) {
+		std::vector<cellMask> form = canonicalSolution();
+		for (int i = 0; i < (int)distinctSolutions.size(); ++i) {
+			if (distinctSolutions[i] == form) {
+				return; // A copy of a solution already found
 			}
 		}
+		distinctSolutions.push_back(form);
+		finished = distinctSolutions.size() > 1;
+		return;
+	}
+
+	if (enumerateAll) {
+		// Only materialise the solution when someone is listening
+		if (sink != 0) {
+			std::unique_lock<std::mutex> guard;
+			if (sinkLock != 0) {
+				guard = std::unique_lock<std::mutex>(*sinkLock);
+			}
+			sink->addSolution(box, placedMasks, wrappedPieces);
+		}
+		return;
+	}
+
+	finished = true;
+
+	// Only the first of several parallel workers to get here keeps its solution
+	if (stopFlag != 0 && stopFlag->exchange(true)) {
+		return;
 	}
+
+	solved = true;
+	log() << "Finished!!! Please print out cube." << std::endl;
 }
 
-// Removes a single piece from the grid
-void cubeSolver::removePiece(int id) {
-	for (unsigned int z = 0; z < SIZE; ++z) {
-		for (unsigned int y = 0; y < SIZE; ++y) {
-			for (unsigned int x = 0; x < SIZE; ++x) {
-				if (grid[z][y][x] == id) {
-					grid[z][y][x] = 0;
+// True unless a rotation of the box which leaves the anchor piece where it
+// is turns the solution in the grid into a smaller one. Symmetry breaking
+// keeps every anchor placement which is the smallest of its rotations, so
+// when that placement is itself symmetric these rotations still produce
+// copies of the solution, of which only the smallest is kept.
+bool cubeSolver::leastRotatedCopy() const {
+	cellMask anchor = placedMasks[anchorLevel];
+	for (int s = 0; s < (int)boxSymmetries.size(); ++s) {
+		if (boxSymmetries[s] == 0 || placements.rotateMask(anchor, boxSymmetries[s]) != anchor) {
+			continue;
+		}
+		// The first piece the rotation moves decides which copy is smaller
+		for (int i = 0; i < (int)placedMasks.size(); ++i) {
+			cellMask rotated = placements.rotateMask(placedMasks[i], boxSymmetries[s]);
+			if (rotated != placedMasks[i]) {
+				if (rotated < placedMasks[i]) {
+					return false;
 				}
+				break;
+			}
+		}
+	}
+	return true;
+}
+
+// The solution held in the grid in a form shared by its rotated copies
+// and by copies with identical pieces swapped
+std::vector<cellMask> cubeSolver::canonicalSolution() const {
+	// Sorting the masks forgets which piece is where, then the smallest
+	// over every rotation of the box picks one of the rotated copies
+	std::vector<cellMask> best, rotated(placedMasks.size());
+	for (int s = 0; s < (int)boxSymmetries.size(); ++s) {
+		for (int i = 0; i < (int)placedMasks.size(); ++i) {
+			rotated[i] = placements.rotateMask(placedMasks[i], boxSymmetries[s]);
+		}
+		std::sort(rotated.begin(), rotated.end());
+		if (s == 0 || rotated < best) {
+			best = rotated;
+		}
+	}
+	return best;
+}
+
+// Works out boxSymmetries and colouringCandidates for the current box
+void cubeSolver::analyseBox() {
+	boxSymmetries.clear();
+	for (int orientation = 0; orientation < 24; ++orientation) {
+		if (placements.preservesBox(orientation)) {
+			boxSymmetries.push_back(orientation);
+		}
+	}
+
+	// A checkerboard, stripes along each axis and diagonals in three bands
+	for (int k = 0; k < maxColourings; ++k) {
+		colouringCandidates[k] = 0;
+	}
+	for (int cell = 0; cell < box.cells(); ++cell) {
+		int x = box.getPosition(cell, 0), y = box.getPosition(cell, 1), z = box.getPosition(cell, 2);
+		int marked[maxColourings] = { (x + y + z) % 2, x % 2, y % 2, z % 2,
+			(x + y + z) % 3 == 1 ? 1 : 0, (x + y + z) % 3 == 2 ? 1 : 0 };
+		for (int k = 0; k < maxColourings; ++k) {
+			if (marked[k]) {
+				colouringCandidates[k] |= cellBit(cell);
+			}
+		}
+	}
+	boxAnalysed = true;
+}
+
+// Sets up the constrainedSearch state from the placement table
+void cubeSolver::buildCandidates() {
+	placementOffset.clear();
+	// Keep the memory of each position's list from previous puzzles
+	cellPlacements.resize(box.cells());
+	for (int cell = 0; cell < box.cells(); ++cell) {
+		cellPlacements[cell].clear();
+	}
+	candidates.assign(box.cells(), 0);
+	killed.clear();
+
+	placementLevel.clear();
+	placementMask.clear();
+
+	for (int level = 0; level < placements.noOfPieces(); ++level) {
+		placementOffset.push_back((int)placementMask.size());
+		for (int index = 0; index < placements.noOfPlacements(level); ++index) {
+			int id = (int)placementMask.size();
+			placementLevel.push_back(level);
+			placementMask.push_back(placements.getMask(level, index));
+
+			for (cellMask remaining = placementMask[id]; remaining != 0; remaining = withoutLowestCell(remaining)) {
+				int cell = lowestCell(remaining);
+				cellPlacements[cell].push_back(id);
+				candidates[cell]++;
+			}
+		}
+	}
+	placementOffset.push_back((int)placementMask.size());
+
+	alive.assign(placementMask.size(), 1);
+}
+
+// Marks one placement as impossible, updating the candidate counts
+void cubeSolver::killPlacement(int id) {
+	alive[id] = 0;
+	for (cellMask remaining = placementMask[id]; remaining != 0; remaining = withoutLowestCell(remaining)) {
+		candidates[lowestCell(remaining)]--;
+	}
+	killed.push_back(id);
+}
+
+// Kills every placement which conflicts with placing the given one
+void cubeSolver::killConflicts(int id) {
+	int level = placementLevel[id];
+
+	// Other placements of the same piece
+	for (int other = placementOffset[level]; other < placementOffset[level + 1]; ++other) {
+		if (alive[other]) {
+			killPlacement(other);
+		}
+	}
+
+	// Placements of other pieces overlapping this one
+	for (cellMask remaining = placementMask[id]; remaining != 0; remaining = withoutLowestCell(remaining)) {
+		const std::vector<int> &covering = cellPlacements[lowestCell(remaining)];
+		for (int i = 0; i < (int)covering.size(); ++i) {
+			if (alive[covering[i]]) {
+				killPlacement(covering[i]);
+			}
+		}
+	}
+}
+
+// Revives the placements killed since the given size of killed
+void cubeSolver::reviveSince(int mark) {
+	while ((int)killed.size() > mark) {
+		int id = killed.back();
+		killed.pop_back();
+
+		alive[id] = 1;
+		for (cellMask remaining = placementMask[id]; remaining != 0; remaining = withoutLowestCell(remaining)) {
+			candidates[lowestCell(remaining)]++;
+		}
+	}
+}
+
+// Builds fillableSizes from the sizes of the pieces
+void cubeSolver::buildFillableSizes() {
+	// Working up from the last piece, each may be left out or added to
+	// every size the pieces after it can make
+	fillableSizes.assign(wrappedPieces.size() + 1, cellMask(1));
+	for (int level = (int)wrappedPieces.size() - 1; level >= 0; --level) {
+		fillableSizes[level] = fillableSizes[level + 1] | (fillableSizes[level + 1] << wrappedPieces[level].size());
+	}
+}
+
+// True if every connected empty region of the grid has a size within
+// the given subset sizes
+bool cubeSolver::regionsFillable(const cellMask &sizes) const {
+	cellMask empty = ~grid & box.allCells();
+	while (empty != 0) {
+		cellMask region = kernels.growRegion(lowestCellOnly(empty), empty, box);
+		// A single region holding every empty position is filled by
+		// using every remaining piece
+		if (region == empty) {
+			return true;
+		}
+		if (!hasCell(sizes, cellCount(region))) {
+			return false;
+		}
+		empty &= ~region;
+	}
+	return true;
+}
+
+// Builds the colourings checked by the search and what each piece and
+// placement covers of them. Returns false if the pieces can never cover
+// the marked positions of some colouring exactly, i.e. there is no solution.
+bool cubeSolver::buildColourings() {
+	// Each colouring marks some positions of the box. However a piece is
+	// placed it covers one of a few numbers of marked positions, e.g. an L
+	// tromino always covers 1 or 2 black positions of a checkerboard, and
+	// between them the pieces must cover every marked position exactly.
+	static const char *names[maxColourings] = { "checkerboard", "x stripes", "y stripes", "z stripes",
+		"diagonals 1 of 3", "diagonals 2 of 3" };
+	const cellMask *candidates = colouringCandidates;
+
+	int pieces = placements.noOfPieces();
+	colourings.clear();
+	colouringNames.clear();
+	pieceColours.assign(pieces, std::vector<cellMask>());
+	reachableColours.assign(pieces + 1, std::vector<cellMask>());
+	std::vector<cellMask> counts(pieces), reachable(pieces + 1);
+	for (int k = 0; k < maxColourings; ++k) {
+		bool repeated = candidates[k] == 0;
+		for (int other = 0; other < k && !repeated; ++other) {
+			repeated = candidates[other] == candidates[k];
+		}
+		if (repeated) {
+			continue;
+		}
+
+		// The numbers of marked positions each piece can cover, then every
+		// total the pieces from each level onwards can cover together
+		bool varies = false;
+		for (int p = 0; p < pieces; ++p) {
+			counts[p] = 0;
+			for (int index = 0; index < placements.noOfPlacements(p); ++index) {
+				counts[p] |= cellBit(cellCount(placements.getMask(p, index) & candidates[k]));
+			}
+			varies = varies || cellCount(counts[p]) > 1;
+		}
+		reachable[pieces] = 1;
+		for (int p = pieces - 1; p >= 0; --p) {
+			reachable[p] = 0;
+			for (cellMask remaining = counts[p]; remaining != 0; remaining = withoutLowestCell(remaining)) {
+				reachable[p] |= reachable[p + 1] << lowestCell(remaining);
+			}
+		}
+
+		if (!hasCell(reachable[0], cellCount(candidates[k]))) {
+			log() << "No solution: the pieces can never cover the [" << cellCount(candidates[k])
+				<< "] marked positions of the " << names[k] << " colouring of the box." << std::endl;
+			colourings.clear();
+			return false;
+		}
+
+		// Pieces which always cover the same number leave nothing to prune
+		if (varies) {
+			colourings.push_back(candidates[k]);
+			colouringNames.push_back(names[k]);
+			for (int p = 0; p < pieces; ++p) {
+				pieceColours[p].push_back(counts[p]);
+			}
+			for (int p = 0; p <= pieces; ++p) {
+				reachableColours[p].push_back(reachable[p]);
 			}
 		}
 	}
+
+	int kept = (int)colourings.size();
+	placementColours.resize(pieces);
+	for (int p = 0; p < pieces; ++p) {
+		placementColours[p].resize(placements.noOfPlacements(p) * kept);
+		for (int index = 0; index < placements.noOfPlacements(p); ++index) {
+			for (int k = 0; k < kept; ++k) {
+				placementColours[p][index * kept + k] = cellCount(placements.getMask(p, index) & colourings[k]);
+			}
+		}
+	}
+	return true;
+}
+
+// The marked positions of each colouring left for the unplaced pieces
+void cubeSolver::neededColours(int *needed) const {
+	for (int k = 0; k < (int)colourings.size(); ++k) {
+		needed[k] = cellCount(colourings[k] & ~grid);
+	}
 }
 
-// Adds a single piece to the grid
-bool cubeSolver::addPieceToGrid(piece &toAdd) {
-	for (int i = 0; i < toAdd.size(); ++i) {
-		element elem = toAdd.getElement(i);
-		if (grid[elem.get(2)][elem.get(1)][elem.get(0)] != 0) {
-			return false; // Overlap detected
+// True if, after the given placement index of the piece at a level, the
+// pieces after it can still cover the marked positions needed
+bool cubeSolver::coloursReachable(int level, int index, const int *needed) const {
+	int kept = (int)colourings.size();
+	const int *covered = &placementColours[level][index * kept];
+	for (int k = 0; k < kept; ++k) {
+		int left = needed[k] - covered[k];
+		if (left < 0 || !hasCell(reachableColours[level + 1][k], left)) {
+			return false;
 		}
 	}
+	return true;
+}
 
-	for (int i = 0; i < toAdd.size(); ++i) {
-		element elem = toAdd.getElement(i);
-		grid[elem.get(2)][elem.get(1)][elem.get(0)] = toAdd.getId();
+// True if the unplaced pieces, in any order, can still cover the marked
+// positions of every colouring left empty
+bool cubeSolver::remainingColoursReachable() const {
+	for (int k = 0; k < (int)colourings.size(); ++k) {
+		cellMask reachable = 1;
+		for (int level = 0; level < (int)wrappedPieces.size(); ++level) {
+			if (placedMasks[level] != 0) {
+				continue;
+			}
+			cellMask totals = 0;
+			for (cellMask remaining = pieceColours[level][k]; remaining != 0; remaining = withoutLowestCell(remaining)) {
+				totals |= reachable << lowestCell(remaining);
+			}
+			reachable = totals;
+		}
+		if (!hasCell(reachable, cellCount(colourings[k] & ~grid))) {
+			return false;
+		}
 	}
 	return true;
 }
 
-// Increment the iteration counter and output progress logging
-void cubeSolver::incrementCount() {
-	count++;
-	if (count % 1000000 == 0) {
-		std::cout << "Iteration: " << count << std::endl;
+// Empties the entire grid of all pieces
+void cubeSolver::clearGrid() {
+	grid = 0;
+	for (int i = 0; i < (int)placedMasks.size(); ++i) {
+		placedMasks[i] = 0;
 	}
 }
 
+// Removes a single piece from the grid
+void cubeSolver::removePiece(int level) {
+	grid ^= placedMasks[level];
+	placedMasks[level] = 0;
+}
 
-std::ostream &operator<< (std::ostream &os, const cubeSolver &cube) {
-	os << "Cube:" << std::endl;
-	for (unsigned int y = 0; y < SIZE; ++y) {
-		for (unsigned int z = 0; z < SIZE; ++z) {
-			for (unsigned int x = 0; x < SIZE; ++x) {
-				os << cube.grid[z][y][x] << " ";
+// Adds a single placement of a piece to the grid
+bool cubeSolver::addPieceToGrid(int level, cellMask toAdd) {
+	if (overlaps(grid, toAdd)) {
+		return false; // Overlap detected
+	}
+
+	placePiece(level, toAdd);
+	return true;
+}
+
+// Adds a placement already known not to overlap the grid
+void cubeSolver::placePiece(int level, cellMask toAdd) {
+	grid |= toAdd;
+	placedMasks[level] = toAdd;
+}
+
+// The stream progress is printed to, which discards it unless verbose
+std::ostream &cubeSolver::log() const {
+	return verbose ? std::cout : silent;
+}
+
+// Counts a visit to a depth, checking the clock every clockPeriod visits
+void cubeSolver::visitNode(int depth) {
+	if (--clockCountdown == 0) {
+		checkClock(depth);
+		if (aborted) {
+			return; // Not visited after all
+		}
+	}
+	stats.node(depth);
+}
+
+// Prints a JSON line of progress if a second has passed since the last,
+// and saves a checkpoint at the depth about to be visited if one is due
+void cubeSolver::checkClock(int depth) {
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+#if SEARCH_STATS
+	// Parallel workers only count, their totals are reported once merged
+	if (verbose && stopFlag == 0 && seconds - lastProgressSeconds >= 1.0) {
+		lastProgressSeconds = seconds;
+		stats.printProgress(log(), seconds, solutionCount);
+	}
+#endif
+
+	// The node being visited is the last of the period, so nodeLimit is
+	// only exceeded once more than that many were visited
+	clockedNodes += clockPeriod;
+	long long int nodes = sharedNodes != 0 ? sharedNodes->fetch_add(clockPeriod) + clockPeriod : clockedNodes;
+	// Like the node limit, the deadline counts this run only, however long
+	// the runs before a checkpoint took
+	double runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - callStartTime).count();
+	if (cancelToken != 0 && cancelToken->load(std::memory_order_relaxed)) {
+		aborted = true;
+		status = cancelledStatus;
+	}
+	else if (deadlineSeconds > 0 && runSeconds >= deadlineSeconds) {
+		aborted = true;
+		status = timedOutStatus;
+	}
+	else if (nodeLimit > 0 && nodes > nodeLimit) {
+		aborted = true;
+		status = nodeLimitStatus;
+	}
+
+	if (aborted) {
+		// Stop the other parallel workers too
+		if (stopFlag != 0) {
+			stopFlag->store(true);
+		}
+		if (checkpointing) {
+			lastCheckpointSeconds = seconds;
+			saveCheckpoint(depth, false);
+		}
+		return;
+	}
+
+	if (checkpointing && seconds - lastCheckpointSeconds >= checkpointSeconds) {
+		lastCheckpointSeconds = seconds;
+		saveCheckpoint(depth, false);
+	}
+
+	clockPeriod = nextClockPeriod();
+	clockCountdown = clockPeriod;
+}
+
+// The number of nodes to visit before the clock is next checked
+int cubeSolver::nextClockPeriod() const {
+	int period = deadlineSeconds > 0 || cancelToken != 0 ? nodesPerLimitCheck : nodesPerClockCheck;
+	// Check again on the first node beyond the limit
+	if (nodeLimit > 0 && nodeLimit + 1 - clockedNodes < period) {
+		period = nodeLimit + 1 - clockedNodes < 1 ? 1 : (int)(nodeLimit + 1 - clockedNodes);
+	}
+	return period;
+}
+
+// Whilst carrying on from a checkpoint, returns the index the loop at a
+// depth restarts from and marks the depth partial, as its placements
+// before that index were searched and counted before the checkpoint.
+// Reaching the checkpoint's own depth ends the resume.
+int cubeSolver::resumeFrom(int depth, bool &partial) {
+	partial = false;
+	if (resumeDepth < 0) {
+		return 0;
+	}
+	if (depth < resumeDepth) {
+		partial = true;
+		return resumeCursor[depth];
+	}
+	resumeDepth = -1;
+	return 0;
+}
+
+// Deals out the way of placing the first shardLevels pieces just made,
+// returning true if it goes to this shard
+bool cubeSolver::dealToShard() {
+	return shardTasks++ % shardCount == shardIndex;
+}
+
+// Identifies the puzzle, placement order and search options of the last
+// solve(), equal for every shard of one search
+unsigned long long cubeSolver::fingerprint() const {
+	// FNV-1a over every value which changes the order of the search
+	unsigned long long hash = 14695981039346656037ULL;
+	std::vector<unsigned long long> values;
+	values.push_back((unsigned long long)activeMode);
+	values.push_back(enumerateAll ? 1 : 0);
+	values.push_back(symmetryBreaking || checkUniqueness ? (unsigned long long)anchorLevel + 1 : 0);
+	values.push_back(checkUniqueness ? 1 : 0);
+	values.push_back(pruneRegions ? 1 : 0);
+	values.push_back(pruneColours ? 1 : 0);
+	values.push_back((unsigned long long)shardLevels);
+	for (int dir = 0; dir < 3; ++dir) {
+		values.push_back((unsigned long long)box.get(dir));
+	}
+	for (int p = 0; p < placements.noOfPieces(); ++p) {
+		values.push_back((unsigned long long)placements.noOfPlacements(p));
+		for (int index = 0; index < placements.noOfPlacements(p); ++index) {
+			for (int word = 0; word < cellMaskWords; ++word) {
+				values.push_back(maskWord(placements.getMask(p, index), word));
+			}
+			values.push_back((unsigned long long)placements.getOrientation(p, index));
+		}
+	}
+
+	for (int i = 0; i < (int)values.size(); ++i) {
+		hash ^= values[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+// Saves the search position, about to visit the given depth, or its
+// results when complete
+void cubeSolver::saveCheckpoint(int depth, bool complete) {
+	searchCheckpoint saved;
+	saved.fingerprint = fingerprint();
+	saved.complete = complete;
+	if (!complete) {
+		saved.depth = depth;
+		saved.cursor.assign(cursor.begin(), cursor.begin() + depth);
+		if (activeMode == referenceSearch) {
+			saved.orientations = currentOrientations;
+		}
+	}
+	saved.solved = solved;
+	if (solved) {
+		saved.placedMasks = placedMasks;
+	}
+	saved.solutions = solutionCount;
+	saved.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	saved.firstSolutionSeconds = firstSolutionSeconds;
+	saved.stats = stats;
+
+	if (!saved.save(checkpointFile)) {
+		log() << "Cannot write checkpoint [" << checkpointFile << "]" << std::endl;
+	}
+}
+
+// Restores a checkpoint, returning true if its search was complete
+bool cubeSolver::restoreCheckpoint(const searchCheckpoint &saved) {
+	stats = saved.stats;
+	solutionCount = saved.solutions;
+	firstSolutionSeconds = saved.firstSolutionSeconds;
+	startTime = std::chrono::steady_clock::now()
+		- std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(saved.elapsedSeconds));
+	lastProgressSeconds = saved.elapsedSeconds;
+	lastCheckpointSeconds = saved.elapsedSeconds;
+
+	if (saved.complete) {
+		if (saved.solved && saved.placedMasks.size() == placedMasks.size()) {
+			placedMasks = saved.placedMasks;
+			grid = 0;
+			for (int level = 0; level < (int)placedMasks.size(); ++level) {
+				grid |= placedMasks[level];
 			}
-			os << " ";
+			solved = true;
 		}
-		os << std::endl;
+		return true;
 	}
+
+	resumeDepth = saved.depth;
+	resumeCursor = saved.cursor;
+	if (activeMode == referenceSearch && saved.orientations.size() == currentOrientations.size()) {
+		currentOrientations = saved.orientations;
+	}
+	return false;
+}
+
+
+std::ostream &operator<< (std::ostream &os, const cubeSolver &cube) {
+	placementTable::printGrid(os, cube.box, cube.placedMasks, cube.wrappedPieces);
 	return os;
 }
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <iostream>
+#include "cellMask.h"
+
+/* Class holding the size of the box the pieces are packed into, which need
+not be a cube. Positions are numbered x + sizeX * (y + sizeY * z), which is
+the bit used for position (x,y,z) within a cellMask. As a cellMask holds
+maxBoxCells bits the box may contain at most that many positions, and at
+most 64 along any one axis.*/
+class boxDimensions {
+
+	// The number of positions along the x, y and z axis
+	int sizes[3];
+
+public:
+
+	// Constructor taking in the size along the x, y and z axis,
+	// by default the 3 x 3 x 3 cube of the original puzzle
+	boxDimensions(int x = 3, int y = 3, int z = 3);
+
+	// The number of positions along the dir axis
+	int get(int) const;
+
+	// The total number of positions
+	int cells() const;
+
+	// True when all three sizes are equal
+	bool isCube() const;
+
+	// Converts a position into its cell index
+	int cellIndex(int, int, int) const;
+
+	// Converts a cell index back into its position along the dir axis
+	int getPosition(int, int) const;
+
+	// A mask holding every position of the box
+	cellMask allCells() const;
+
+	// A mask holding the positions at the given position along the dir axis
+	cellMask planeCells(int, int) const;
+};
+
+std::ostream &operator<< (std::ostream &, const boxDimensions &);
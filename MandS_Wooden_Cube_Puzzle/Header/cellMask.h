@@ -0,0 +1,84 @@
+#pragma once
+
+/* A set of box positions, one bit per position as numbered by
+boxDimensions::cellIndex(). By default a single 64-bit word, limiting the
+box to at most 64 positions, e.g. 4 x 4 x 4. Building with
+-DMAX_BOX_CELLS=n for n up to 512 makes a cellMask a wideMask of as many
+64-bit words as n needs, rounded up to 2, 4 or 8 words, e.g. 125 for
+5 x 5 x 5 or 216 for 6 x 6 x 6. The helpers below work on either.*/
+#ifndef MAX_BOX_CELLS
+#define MAX_BOX_CELLS 64
+#endif
+
+// True if the two masks share at least one cell
+inline bool overlaps(unsigned long long a, unsigned long long b) {
+	return (a & b) != 0;
+}
+
+// Returns the number of cells set within a mask
+inline int cellCount(unsigned long long mask) {
+#ifdef _MSC_VER
+	return (int)__popcnt64(mask);
+#else
+	return __builtin_popcountll(mask);
+#endif
+}
+
+// Returns the index of the lowest cell set within a non-empty mask
+inline int lowestCell(unsigned long long mask) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, mask);
+	return (int)index;
+#else
+	return __builtin_ctzll(mask);
+#endif
+}
+
+// Returns a non-empty mask without its lowest cell
+inline unsigned long long withoutLowestCell(unsigned long long mask) {
+	return mask & (mask - 1);
+}
+
+// Returns a mask holding only the lowest cell of a non-empty mask
+inline unsigned long long lowestCellOnly(unsigned long long mask) {
+	return mask & (0 - mask);
+}
+
+// True if the mask holds the given cell index
+constexpr bool hasCell(unsigned long long mask, int cell) {
+	return ((mask >> cell) & 1) != 0;
+}
+
+// The word-th 64 positions of a mask, there being only the one word
+inline unsigned long long maskWord(unsigned long long mask, int) {
+	return mask;
+}
+
+#include "wideMask.h"
+
+#if MAX_BOX_CELLS <= 64
+typedef unsigned long long cellMask;
+#elif MAX_BOX_CELLS <= 128
+typedef wideMask<2> cellMask;
+#elif MAX_BOX_CELLS <= 256
+typedef wideMask<4> cellMask;
+#elif MAX_BOX_CELLS <= 512
+typedef wideMask<8> cellMask;
+#else
+#error "MAX_BOX_CELLS may be at most 512"
+#endif
+
+// The number of 64-bit words in a cellMask and so the most positions a box may hold
+static const int cellMaskWords = (int)(sizeof(cellMask) / sizeof(unsigned long long));
+static const int maxBoxCells = 64 * cellMaskWords;
+
+// Returns a mask holding only the given cell index
+constexpr cellMask cellBit(int cell) {
+	return cellMask(1) << cell;
+}
+
+// Returns a mask holding the cell indices 0 to count - 1
+inline cellMask firstCells(int count) {
+	return count >= maxBoxCells ? ~cellMask(0) : ~(~cellMask(0) << count);
+}
\ No newline at end of file
@@ -1,17 +1,62 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
 #include <vector>
 #include "wrappedPiece.h"
+#include "solutionSink.h"
+#include "placementTable.h"
+#include "boxDimensions.h"
+#include "searchKernels.h"
+#include "searchStats.h"
+#include "transpositionTable.h"
+#include "searchCheckpoint.h"
+#include "cellMask.h"
 
 /* Class to represent the puzzle cube itself. After construction
 call addPiece() to add each piece in turn, finally call solve().
 This class has been designed to be independent of both the number
-and shape of the puzzle pieces. The size of the cube can be adjusted
-by changing "#define SIZE".*/
+and shape of the puzzle pieces. The size of the cube is given on
+construction and need not be a cube at all, any box of at most
+maxBoxCells positions may be filled (see cellMask.h).*/
 class cubeSolver {
 
-	// Grid to track which cube positions are occupied
-	std::vector<std::vector<std::vector<int> > > grid;
+public:
+
+	// How the search chooses placements:
+	// - referenceSearch fixes an orientation for every piece in outerSolver()
+	//   before innerSolver() tries their locations. Kept for comparing results.
+	// - interleavedSearch chooses orientation and location together per piece
+	//   so that an overlap prunes the whole subtree beneath it.
+	// - constrainedSearch fills the empty position with the fewest placements
+	//   still able to cover it first and backtracks as soon as any empty
+	//   position cannot be covered. Requires the pieces to fill the cube.
+	enum searchMode { referenceSearch, interleavedSearch, constrainedSearch };
+
+	// Why solve() returned:
+	// - solvedStatus after finding a solution (or every solution asked for).
+	// - exhaustedStatus after searching everything without finding one.
+	// - timedOutStatus, cancelledStatus and nodeLimitStatus when the
+	//   deadline, the cancel token or the node limit stopped it early.
+	enum solveStatus { solvedStatus, exhaustedStatus, timedOutStatus, cancelledStatus, nodeLimitStatus };
+
+private:
+
+	// The box being filled
+	boxDimensions box;
+
+	// The hot loops over every box position, specialised for the box size
+	searchKernels kernels;
+
+	// Bitboard to track which cube positions are occupied
+	cellMask grid;
+
+	// The mask each piece currently occupies within the grid (0 if
+	// the piece is not placed) with a 1-to-1 correspondence with
+	// each wrappedPiece within wrappedPieces
+	std::vector<cellMask> placedMasks;
 
 	// The wrapped pieces
 	std::vector<wrappedPiece> wrappedPieces;
@@ -20,40 +65,460 @@ class cubeSolver {
 	// correspondence with each wrappedPiece within wrappedPieces
 	std::vector<int> noOfLocations;
 
-	// Iterations performed whilst solving
-	long int count;
+	// Every legal placement of every piece, built once by solve()
+	placementTable placements;
+
+	// The distinct orientation currently chosen by outerSolver() for each piece
+	std::vector<int> currentOrientations;
+
+	// Per-depth counters of the search, see searchStats
+	searchStats stats;
+
+	// Seconds into solve() at which progress was last reported
+	double lastProgressSeconds;
+
+	// Reading the clock on every node would cost more than the node itself,
+	// so visitNode() only reads it once every nodesPerClockCheck nodes, or
+	// every nodesPerLimitCheck nodes when a deadline or cancel token must
+	// be noticed promptly. clockPeriod is the number of nodes between the
+	// last check and the next, clockedNodes those visited up to the last.
+	static const int nodesPerClockCheck = 1 << 16;
+	static const int nodesPerLimitCheck = 1 << 12;
+	int clockCountdown;
+	int clockPeriod;
+	long long int clockedNodes;
+
+	// When solve() gives up: after deadlineSeconds (0 for never), after
+	// visiting nodeLimit nodes (0 for no limit) or once another thread sets
+	// the cancel token (null for none)
+	double deadlineSeconds;
+	long long int nodeLimit;
+	std::atomic<bool> *cancelToken;
+
+	// Nodes visited by every parallel worker together, null otherwise
+	std::atomic<long long int> *sharedNodes;
+
+	// Whether the current solve() gave up, and the status it returns
+	bool aborted;
+	solveStatus status;
+
+	// Where and how often (in seconds) the search position is saved, empty
+	// for never, and whether solve() first carries on from the saved position
+	std::string checkpointFile;
+	double checkpointSeconds;
+	bool resume;
+
+	// Whether the current solve() saves checkpoints and when it last did
+	bool checkpointing;
+	double lastCheckpointSeconds;
+
+	// The index reached by the loop at each depth, for checkpoints
+	std::vector<int> cursor;
+
+	// Whilst carrying on from a checkpoint, the depth it was saved at and
+	// the cursor leading back down to it. resumeDepth is -1 otherwise.
+	int resumeDepth;
+	std::vector<int> resumeCursor;
+
+	// The search mode requested and the one the current solve() uses
+	searchMode mode;
+	searchMode activeMode;
+
+	// State for constrainedSearch. Placements are numbered consecutively
+	// across all pieces, placementOffset[p] being the first of piece p.
+	std::vector<int> placementOffset;
+
+	// The piece (by order of addition) and mask of each numbered placement
+	std::vector<int> placementLevel;
+	std::vector<cellMask> placementMask;
+
+	// The placements covering each cube position
+	std::vector<std::vector<int> > cellPlacements;
+
+	// Whether each placement is still possible, i.e. its piece is unused
+	// and it does not overlap the grid
+	std::vector<char> alive;
+
+	// The number of live placements covering each cube position
+	std::vector<int> candidates;
+
+	// Placements made impossible, in order, so they can be revived on backtrack
+	std::vector<int> killed;
+
+	// Whether a solution has been found and is held in the grid
+	bool solved;
+
+	// The number of worker threads used by solve() and the depth, in
+	// pieces, above which the interleaved search is split into tasks
+	int threads;
+	int splitDepth;
+
+	// Which shard (0 to shardCount - 1) of shardCount disjoint shards
+	// solve() searches. The ways of placing (or for the reference search
+	// orientating) the first shardLevels pieces are dealt out to the shards
+	// in turn, shardTasks counting those dealt so far. shardLevels is 0
+	// when the search is not sharded.
+	int shardIndex;
+	int shardCount;
+	int shardLevels;
+	long long int shardTasks;
+
+	// Set once any parallel worker has found a solution so the others stop.
+	// Null when solving on a single thread.
+	std::atomic<bool> *stopFlag;
+
+	// Whether solve() carries on after a solution to find every solution,
+	// and where each solution is sent (null to only count them)
+	bool enumerateAll;
+	solutionSink *sink;
+
+	// Serialises calls to the sink between parallel workers, null otherwise
+	std::mutex *sinkLock;
+
+	// Solutions found, when the search started and the seconds it took to
+	// find the first solution (negative until one is found). Resuming from
+	// a checkpoint moves startTime back by the time already spent, whereas
+	// callStartTime is always when this solve() started.
+	long long int solutionCount;
+	std::chrono::steady_clock::time_point startTime, callStartTime;
+	double firstSolutionSeconds;
+
+	// Every time all the pieces were placed, including rotated copies
+	// symmetry breaking then drops. Whether a copy is dropped depends on
+	// pieces placed above a state, so the transposition table only records
+	// states beneath which no completion was reached at all.
+	long long int completions;
+
+	// Whether progress and statistics are printed whilst solving
+	bool verbose;
+
+	// Whether the search abandons a placement which leaves an empty region
+	// no combination of the remaining pieces can fill, and whether that is
+	// in use for the current solve() (only when the pieces fill the box)
+	bool regionPruning;
+	bool pruneRegions;
+
+	// For each level, the bit for every total size some subset of the
+	// pieces from that level onwards adds up to. Sizes never exceed the
+	// positions in the box, so a cellMask holds every bit.
+	std::vector<cellMask> fillableSizes;
+
+	// Whether the search abandons placements after which the remaining
+	// pieces can no longer cover the marked positions of a colouring of the
+	// box, and whether that is in use for the current solve() (only when the
+	// pieces fill the box)
+	bool colourPruning;
+	bool pruneColours;
+
+	// The colourings tried by buildColourings()
+	static const int maxColourings = 6;
+
+	// The marked positions of each colouring the current solve() checks,
+	// e.g. the black positions of a checkerboard, and its name
+	std::vector<cellMask> colourings;
+	std::vector<const char *> colouringNames;
+
+	// For each piece and colouring, the bit for every number of marked
+	// positions some placement of the piece covers
+	std::vector<std::vector<cellMask> > pieceColours;
+
+	// For each level and colouring, the bit for every number of marked
+	// positions the pieces from that level onwards can cover together
+	std::vector<std::vector<cellMask> > reachableColours;
+
+	// The marked positions each placement covers of every colouring in
+	// turn, indexed [level][index * colourings.size() + colouring]
+	std::vector<std::vector<int> > placementColours;
+
+	// States proven to have no completion. Whether the table is wanted and
+	// the table searched, either this solver's own or for parallel workers
+	// the one shared from the solver they were copied from. Null when the
+	// current solve() does not use one.
+	transpositionTable failedStates;
+	bool useTable;
+	transpositionTable *table;
+
+	// Whether solve() discards the rotated copies of each solution and
+	// which piece (by order of addition) is restricted to achieve this
+	bool symmetryBreaking;
+	int anchorLevel;
+
+	// Whether solve() only checks that the solution is unique up to rotation
+	// of the whole box, and the canonical form (see canonicalSolution()) of
+	// each distinct solution found so far
+	bool checkUniqueness;
+	std::vector<std::vector<cellMask> > distinctSolutions;
+
+	// What depends only on the box, kept from puzzle to puzzle of the same
+	// size: the rotations (orientations 0 to 23) mapping the box onto itself
+	// and the marked positions of each colouring tried by buildColourings().
+	// boxAnalysed is false until they are worked out for the current box.
+	bool boxAnalysed;
+	std::vector<int> boxSymmetries;
+	cellMask colouringCandidates[maxColourings];
 
 public:
 
 	friend std::ostream &operator<< (std::ostream &, const cubeSolver &);
 
-	cubeSolver();
+	// Times the private hot paths
+	friend class solverBenchmark;
+
+	// Runs the interleaved search one solution at a time
+	friend class solutionIterator;
+
+	// Constructor taking in the size of the box, by default a 3 x 3 x 3 cube
+	cubeSolver(const boxDimensions &dimensions = boxDimensions());
+
+	// Forget all pieces so that another puzzle can be solved in a box of the
+	// given size. The search options and memory already allocated are kept.
+	cubeSolver &reset(const boxDimensions &);
 
 	// Inform the cube of a puzzle piece
 	cubeSolver &addPiece(const piece &);
 
+	// Select how solve() searches, interleavedSearch by default
+	cubeSolver &setSearchMode(searchMode);
+
+	// Only search for solutions which are distinct under rotation of the
+	// whole cube by restricting the placements of the given anchor piece.
+	// Rotated copies which leave the anchor where it is are then dropped as
+	// they are found. Off by default.
+	cubeSolver &setSymmetryBreaking(bool, int anchor = 0);
+
+	// Only check whether the puzzle has a unique solution up to rotation of
+	// the whole box, stopping as soon as a second distinct solution is found.
+	// Solutions differing only by swapping identical pieces are the same.
+	// Breaks symmetry as setSymmetryBreaking() does. Off by default.
+	cubeSolver &setUniquenessCheck(bool);
+
+	// Solve on several threads. The interleaved search is split into one task
+	// per way of placing the first splitDepth pieces and the tasks are shared
+	// out by a work-stealing pool. A single thread by default.
+	cubeSolver &setThreads(int, int splitDepth = 2);
+
+	// Search only one shard, index 0 to count - 1, of count disjoint shards.
+	// Every way of placing the first splitDepth pieces (see setThreads()),
+	// or for the reference search of orientating them, goes to one shard
+	// in turn. Together the shards of a puzzle solved with the same options
+	// search exactly what a single search would, in separate processes or
+	// on separate machines. A single shard by default.
+	cubeSolver &setShard(int, int);
+
+	// Find every solution rather than stopping at the first. Each one is
+	// passed to the sink as soon as it is found, or only counted when the
+	// sink is null. Off by default.
+	cubeSolver &setEnumerateAll(bool, solutionSink *toUse = 0);
+
+	// Abandon placements leaving an empty region whose size no subset of
+	// the remaining pieces adds up to. Only applies when the pieces fill
+	// the box exactly. On by default.
+	cubeSolver &setRegionPruning(bool);
+
+	// Abandon placements after which the remaining pieces can no longer
+	// cover the marked positions of a colouring of the box, e.g. the black
+	// positions of a checkerboard, and do not search at all when they never
+	// can. Only applies when the pieces fill the box exactly. On by default.
+	cubeSolver &setColourPruning(bool);
+
+	// Cut off states of the grid and remaining pieces which an earlier order
+	// of placements already proved have no completion, remembering them in a
+	// table of 2^bits slots. Off by default.
+	cubeSolver &setTranspositionTable(bool, int bits = 20,
+		transpositionTable::replacementPolicy = transpositionTable::replaceShallower);
+
+	// Save the search position to the file every interval seconds and once
+	// more when the search ends. Only single threaded searches are saved.
+	// Off by default, as is an empty file name.
+	cubeSolver &setCheckpoint(const std::string &, double seconds = 60);
+
+	// Carry on from the position saved in the checkpoint file, if there is
+	// one, rather than starting again. The puzzle and search options must be
+	// those of the run which saved it. Solutions found between the last save
+	// and the interruption are found, and passed to the sink, again.
+	cubeSolver &setResume(bool);
+
+	// Give up once solve() has run for the given seconds, leaving the
+	// statistics of the search so far. 0 for no deadline, the default.
+	cubeSolver &setDeadline(double);
+
+	// Give up after visiting the given number of nodes, 0 for no limit (the
+	// default). Parallel workers may overrun it by a few thousand nodes each.
+	cubeSolver &setNodeLimit(long long int);
+
+	// Give up as soon as another thread sets the flag, which is only read.
+	// Null for none, the default.
+	cubeSolver &setCancelToken(std::atomic<bool> *);
+
+	// Print progress and statistics to std::cout whilst solving, on by default
+	cubeSolver &setVerbose(bool);
+
 	// Solve the puzzle. Call this after adding all puzzle pieces.
-	void solve();
+	// Returns why the search ended.
+	solveStatus solve();
+
+	// Why the last solve() ended
+	solveStatus getStatus() const;
+
+	// A short name for a status, e.g. "timed out"
+	static const char *statusName(solveStatus);
+
+	// True if the last solve() left a solution in the grid
+	bool isSolved() const;
+
+	// The number of solutions found by the last solve()
+	long long int noOfSolutions() const;
+
+	// The number of nodes visited by the last solve()
+	long long int noOfIterations() const;
+
+	// The per-depth counters of the last solve()
+	const searchStats &getStats() const;
+
+	// The distinct solutions found by the last solve() checking uniqueness,
+	// at most 2 as it stops at the second
+	int noOfDistinctSolutions() const;
+
+	// Seconds the last solve() took to find its first solution,
+	// negative if none was found
+	double timeToFirstSolution() const;
+
+	// The mask each piece occupies in the solution left by the last solve()
+	const std::vector<cellMask> &getPlacedMasks() const;
+
+	// The depths every shard of the last solve() walks alike before dealing
+	// out its tasks. Their counters are the same in every shard rather than
+	// adding up to those of a single search.
+	int noOfSharedDepths() const;
+
+	// Identifies the puzzle, placement order and search options of the last
+	// solve(), equal for every shard of one search
+	unsigned long long fingerprint() const;
 
 private:
 
+	// Builds everything the search needs and empties the grid and counters,
+	// choosing activeMode. Returns false if no solution can exist.
+	bool prepareSearch();
+
 	// Cycles through all orientations for every piece
 	void outerSolver(const int, bool &);
 
 	// Cycles through all locations for every now orientated piece
 	void innerSolver(const int, bool &);
 
+	// Cycles through all orientations and locations of one piece at a time
+	void interleavedSolver(const int, bool &);
+
+	// Fills the empty position with the fewest live placements covering it
+	void constrainedSolver(const int, bool &);
+
+	// Runs the interleaved search on a work-stealing pool of threads
+	void parallelSolver(bool &);
+
+	// Collects every non-overlapping combination of placement indices
+	// for the pieces above the given depth, one per parallel task. The
+	// levels above the tasks are counted here as the workers never see them.
+	void collectTasks(const int, const int, std::vector<int> &, std::vector<std::vector<int> > &);
+
+	// Places a task's pieces then searches the remaining pieces
+	void runTask(const std::vector<int> &);
+
+	// Called each time every piece has been placed
+	void foundSolution(bool &);
+
+	// True unless a rotation of the box which leaves the anchor piece where it
+	// is turns the solution in the grid into a smaller one. Symmetry breaking
+	// keeps every anchor placement which is the smallest of its rotations, so
+	// when that placement is itself symmetric these rotations still produce
+	// copies of the solution, of which only the smallest is kept.
+	bool leastRotatedCopy() const;
+
+	// The solution held in the grid in a form shared by its rotated copies
+	// and by copies with identical pieces swapped
+	std::vector<cellMask> canonicalSolution() const;
+
+	// Works out boxSymmetries and colouringCandidates for the current box
+	void analyseBox();
+
+	// Sets up the constrainedSearch state from the placement table
+	void buildCandidates();
+
+	// Marks one placement as impossible, updating the candidate counts
+	void killPlacement(int);
+
+	// Kills every placement which conflicts with placing the given one
+	void killConflicts(int);
+
+	// Revives the placements killed since the given size of killed
+	void reviveSince(int);
+
+	// Builds fillableSizes from the sizes of the pieces
+	void buildFillableSizes();
+
+	// True if every connected empty region of the grid has a size within
+	// the given subset sizes
+	bool regionsFillable(const cellMask &) const;
+
+	// Builds the colourings checked by the search and what each piece and
+	// placement covers of them. Returns false if the pieces can never cover
+	// the marked positions of some colouring exactly, i.e. there is no solution.
+	bool buildColourings();
+
+	// The marked positions of each colouring left for the unplaced pieces
+	void neededColours(int *) const;
+
+	// True if, after the given placement index of the piece at a level, the
+	// pieces after it can still cover the marked positions needed
+	bool coloursReachable(int, int, const int *) const;
+
+	// True if the unplaced pieces, in any order, can still cover the marked
+	// positions of every colouring left empty
+	bool remainingColoursReachable() const;
+
 	// Empties the entire grid of all pieces
 	void clearGrid();
 
 	// Removes a single piece from the grid
 	void removePiece(int);
 
-	// Adds a single piece to the grid
-	bool addPieceToGrid(piece &);
+	// Adds a single placement of a piece to the grid
+	bool addPieceToGrid(int, cellMask);
+
+	// Adds a placement already known not to overlap the grid
+	void placePiece(int, cellMask);
+
+	// Counts a visit to a depth, checking the clock every clockPeriod visits
+	void visitNode(int);
+
+	// Prints a JSON line of progress if a second has passed since the last,
+	// and saves a checkpoint at the depth about to be visited if one is due.
+	// Gives up, saving a checkpoint, once a limit is reached.
+	void checkClock(int);
+
+	// The number of nodes to visit before the clock is next checked
+	int nextClockPeriod() const;
+
+	// Whilst carrying on from a checkpoint, returns the index the loop at a
+	// depth restarts from and marks the depth partial, as its placements
+	// before that index were searched and counted before the checkpoint.
+	// Reaching the checkpoint's own depth ends the resume.
+	int resumeFrom(int, bool &);
+
+
+	// Deals out the way of placing the first shardLevels pieces just made,
+	// returning true if it goes to this shard
+	bool dealToShard();
+
+	// Saves the search position, about to visit the given depth, or its
+	// results when complete
+	void saveCheckpoint(int, bool);
+
+	// Restores a checkpoint, returning true if its search was complete
+	bool restoreCheckpoint(const searchCheckpoint &);
 
-	// Increment the iteration counter and output progress logging
-	void incrementCount();
+	// The stream progress is printed to, which discards it unless verbose
+	std::ostream &log() const;
 };
 
 std::ostream &operator<< (std::ostream &, const cubeSolver &);
\ No newline at end of file
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include "wrappedPiece.h"
+#include "placementTable.h"
+#include "boxDimensions.h"
+#include "cellMask.h"
+
+/* Class solving the puzzle as an exact cover problem using Dancing Links
+(Knuth's Algorithm X). The matrix has one column per cube position plus one
+column per piece, and one row per placement produced by the placementTable.
+A solution picks rows covering every piece column exactly once and every
+position column at most once, or exactly once when the pieces fill the cube.
+It is used in the same way as cubeSolver: after construction call addPiece()
+to add each piece in turn, finally call solve().*/
+class dlxSolver {
+
+	// The box being filled
+	boxDimensions box;
+
+	// The wrapped pieces
+	std::vector<wrappedPiece> wrappedPieces;
+
+	// Every legal placement of every piece, built once by solve()
+	placementTable placements;
+
+	// The mask each piece occupies within the solution (0 if unsolved)
+	std::vector<cellMask> placedMasks;
+
+	// The matrix as four-way linked nodes held in index arrays. Node 0 is
+	// the root and nodes 1 to the number of columns are the column headers.
+	std::vector<int> left, right, up, down;
+
+	// The column header each node belongs to
+	std::vector<int> column;
+
+	// The matrix row each node belongs to (-1 for the root and headers)
+	std::vector<int> row;
+
+	// The number of nodes in each column, indexed by column header
+	std::vector<int> columnSize;
+
+	// The piece and placement index each matrix row was built from
+	std::vector<int> rowPiece, rowPlacement;
+
+	// The matrix row chosen at each depth of the search
+	std::vector<int> chosenRows;
+
+	// Whether solve() discards the rotated copies of each solution and
+	// which piece (by order of addition) is restricted to achieve this
+	bool symmetryBreaking;
+	int anchorLevel;
+
+	// Rows tried whilst solving
+	long long int count;
+
+	// Whether the last solve() found a solution
+	bool solved;
+
+	// Whether the matrix size and outcome are printed by solve()
+	bool verbose;
+
+public:
+
+	friend std::ostream &operator<< (std::ostream &, const dlxSolver &);
+
+	// Constructor taking in the size of the box, by default a 3 x 3 x 3 cube
+	dlxSolver(const boxDimensions &dimensions = boxDimensions());
+
+	// Inform the cube of a puzzle piece
+	dlxSolver &addPiece(const piece &);
+
+	// Only search for solutions which are distinct under rotation of the
+	// whole cube, see cubeSolver::setSymmetryBreaking(). Off by default.
+	dlxSolver &setSymmetryBreaking(bool, int anchor = 0);
+
+	// Print the matrix size and outcome to std::cout, on by default
+	dlxSolver &setVerbose(bool);
+
+	// Solve the puzzle. Call this after adding all puzzle pieces.
+	void solve();
+
+	// True if the last solve() found a solution
+	bool isSolved() const;
+
+	// The number of rows tried by the last solve()
+	long long int noOfIterations() const;
+
+private:
+
+	// Builds the linked matrix from the placement table
+	void buildMatrix();
+
+	// Adds a column header. Primary columns must be covered by every
+	// solution and are linked into the root's list, others are not.
+	void addColumn(bool);
+
+	// Appends one row for a placement of a piece
+	void addRow(int, int);
+
+	// Removes a column and every row intersecting it from the matrix
+	void cover(int);
+
+	// Reverses cover()
+	void uncover(int);
+
+	// Algorithm X, always branching on the column with the fewest rows.
+	// Returns true once a solution has been found.
+	bool search();
+};
+
+std::ostream &operator<< (std::ostream &, const dlxSolver &);
@@ -2,24 +2,28 @@
 
 #include <iostream>
 
-/* Class to act as a single (x,y,z)-point in 3D space.*/
+/* Class to act as a single (x,y,z)-point in 3D space. Each coordinate is
+held in a single byte, indexed directly by axis, which is plenty for a box
+of at most 64 positions along each axis. Trivially copyable, so copies are a few bytes.*/
 class element {
 
-	int x, y, z;
+	signed char coords[3];
 
 public:
 
 	friend std::ostream &operator<< (std::ostream &, const element &);
 
-	element(int, int, int);
-
-	element(const element &);
+	element();
 
-	element &operator= (const element &);
+	element(int, int, int);
 
-	int get(int) const;
+	int get(int dir) const {
+		return coords[dir];
+	}
 
-	void update(int, int);
+	void update(int dir, int val) {
+		coords[dir] = (signed char)val;
+	}
 
 };
 
@@ -1,17 +1,27 @@
 #pragma once
 
 #include <iostream>
-#include <vector>
 #include "element.h"
 
 /* Class to act as a puzzle piece. In particular each piece
 is comprised of one or more elements. A piece also has an ID
-so as to distinguish its boundary from other pieces.*/
+so as to distinguish its boundary from other pieces. The elements
+are stored inline, so a piece never allocates and copying one is a
+plain copy of a few dozen bytes.*/
 class piece {
 
+public:
+
+	// The most elements a single piece may have
+	static const int maxElements = 16;
+
+private:
+
 	int id;
 
-	std::vector<element> elements;
+	int noOfElements;
+
+	element elements[maxElements];
 
 public:
 
@@ -19,24 +29,27 @@ public:
 
 	piece(int);
 
-	piece(const piece &);
-
-	piece &operator= (const piece &);
-
 	int getId() const;
 
 	// Add elements to this piece after construction.
 	// All pieces are constructed "empty" by the base constructor.
+	// Throws std::length_error beyond maxElements.
 	piece &addElement(const element &);
 
-	element getElement(int) const;
+	element getElement(int i) const {
+		return elements[i];
+	}
 
-	element &updateElement(int);
+	element &updateElement(int i) {
+		return elements[i];
+	}
 
 	// Shifts the piece along the x, y or z axis
 	piece &shift(int, int);
 
-	int size() const;
+	int size() const {
+		return noOfElements;
+	}
 
 };
 
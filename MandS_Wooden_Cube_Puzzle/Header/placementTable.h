@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+#include "cellMask.h"
+#include "wrappedPiece.h"
+#include "boxDimensions.h"
+
+/* Class holding every legal placement of every puzzle piece. A placement
+is one (orientation, location) pair of a wrappedPiece, stored as the mask
+of cube positions it occupies. The table is built once, after which the
+solver never needs to rebuild, rotate or shift a piece again.
+Only the distinct orientations of each piece are enumerated. Placements
+of a piece are grouped by orientation so that all locations of a given
+orientation lie in one contiguous index range.*/
+class placementTable {
+
+	// The box the pieces are placed within
+	boxDimensions box;
+
+	// The occupied positions of each placement, one vector per piece
+	std::vector<std::vector<cellMask> > masks;
+
+	// The orientation and location each placement was produced from
+	std::vector<std::vector<int> > orientations, locations;
+
+	// Index of the first placement of each distinct orientation, per piece.
+	// Holds one extra entry so that the i-th distinct orientation spans [i, i + 1).
+	std::vector<std::vector<int> > orientationStart;
+
+public:
+
+	placementTable();
+
+	// Enumerates all placements of all pieces within the box. Each wrappedPiece
+	// is left orientated and located at its final placement afterwards.
+	void build(std::vector<wrappedPiece> &, const boxDimensions &);
+
+	const boxDimensions &getBox() const;
+
+	int noOfPieces() const;
+
+	int noOfPlacements(int) const;
+
+	// Index range [firstPlacement, lastPlacement) of a piece's i-th distinct orientation
+	int firstPlacement(int, int) const;
+
+	int lastPlacement(int, int) const;
+
+	// Rotating the whole box maps every solution onto another solution, so
+	// 24 rotated copies of each exist in a cube (fewer in other boxes, only
+	// rotations mapping the box onto itself count). Keeping only the
+	// placements of one (anchor) piece which are the smallest mask among all
+	// rotations of that mask leaves a single representative of each group
+	// of solutions.
+	void keepCanonicalPlacements(int);
+
+	cellMask getMask(int, int) const;
+
+	// The masks of every placement of a piece, stored contiguously
+	const cellMask *getMasks(int) const;
+
+	int getOrientation(int, int) const;
+
+	int getLocation(int, int) const;
+
+	// True if the rotations of an orientation (0 to 23) map the box onto itself
+	bool preservesBox(int) const;
+
+	// Rotates a mask about the centre of the box using the rotations of an
+	// orientation (0 to 23). The orientation must preserve the box.
+	cellMask rotateMask(cellMask, int) const;
+
+	// Rebuilds the id of the piece occupying each box position from the
+	// mask and id of each piece, indexed [z][y][x]
+	static std::vector<std::vector<std::vector<int> > > buildIdGrid(const boxDimensions &,
+		const std::vector<cellMask> &, const std::vector<int> &);
+
+	// Prints the box given the mask each piece occupies
+	static void printGrid(std::ostream &, const boxDimensions &, const std::vector<cellMask> &, const std::vector<wrappedPiece> &);
+
+	// Prints the box given the mask and id of each piece
+	static void printGrid(std::ostream &, const boxDimensions &, const std::vector<cellMask> &, const std::vector<int> &);
+};
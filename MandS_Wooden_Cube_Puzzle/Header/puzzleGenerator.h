@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include "piece.h"
+#include "boxDimensions.h"
+#include "cubeSolver.h"
+#include "puzzleLoader.h"
+
+/* Class designing new puzzles like the M&S cube. Each candidate splits the
+box into random pieces, which by construction fit together at least one
+way, and is kept only if that is its only solution up to rotation of the
+whole box. The given solver checks each candidate and is reset for the next,
+keeping its memory and everything worked out for the box, so that a
+candidate with a second solution is rejected as soon as it is found.*/
+class puzzleGenerator {
+
+	// The solver checking each candidate, its search options are kept
+	cubeSolver &checker;
+
+	// The box split into pieces and the number of positions each piece is
+	// grown to, the last pieces grown may be smaller
+	boxDimensions box;
+	int pieceSize;
+
+	// The state of the random number generator
+	unsigned int state;
+
+	// Candidates generated and those kept so far
+	long long int candidates;
+	long long int accepted;
+
+public:
+
+	// Constructor taking in the solver to check candidates with, which is set
+	// to check uniqueness, the box, the size of its pieces (1 to
+	// piece::maxElements) and the seed
+	puzzleGenerator(cubeSolver &, const boxDimensions &, int, unsigned int seed = 1);
+
+	// Generates candidates until one has a unique solution and returns it,
+	// or gives up after maxCandidates returning false
+	bool next(puzzleDefinition &, long long int maxCandidates = 1000000);
+
+	// True if the pieces fill the box in exactly one way up to rotation
+	bool isUnique(const std::vector<piece> &);
+
+	// The number of candidates generated so far
+	long long int noOfCandidates() const;
+
+	// The number of candidates kept so far
+	long long int noOfAccepted() const;
+
+	// Splits a box into pieces of roughly pieceSize positions by growing
+	// each piece from the lowest empty position into random empty
+	// neighbours, drawing from and advancing the given generator state
+	static std::vector<piece> dissect(const boxDimensions &, int, unsigned int &);
+};
\ No newline at end of file
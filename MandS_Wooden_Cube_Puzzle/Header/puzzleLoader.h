@@ -0,0 +1,64 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "piece.h"
+#include "boxDimensions.h"
+
+/* A puzzle as read from a definition file: the box and the pieces which
+must be packed into it.*/
+struct puzzleDefinition {
+	boxDimensions box;
+	std::vector<piece> pieces;
+};
+
+/* Class reading puzzle definitions one after another from a stream. Each
+piece is written exactly as piece's operator<< prints it (see Solution.txt),
+one row of coordinates per axis:
+
+	Box: 3 3 3
+	Piece: 1
+	x: 0 1 0 0
+	y: 0 0 1 1
+	z: 0 0 0 1
+	End
+
+The Box line is optional, defaulting to 3 3 3, and starts a new puzzle.
+End closes a puzzle so the next may start without a Box line. Blank lines
+and lines starting with # are ignored. A puzzle needs at least one piece
+and a piece at most piece::maxElements distinct elements, with
+coordinates from -64 to 63. Malformed input throws a std::runtime_error
+naming the offending line.*/
+class puzzleReader {
+
+	std::istream &is;
+
+	// The number of the last line read, for error messages
+	int lineNumber;
+
+	// A line read ahead which belongs to the next puzzle
+	std::string pendingLine;
+	bool hasPending;
+
+public:
+
+	puzzleReader(std::istream &);
+
+	// Reads the next puzzle, returning false once the stream holds no more
+	bool readPuzzle(puzzleDefinition &);
+
+private:
+
+	// Reads the next line which is neither blank nor a comment
+	bool nextLine(std::string &);
+
+	// Reads the "x:", "y:" or "z:" row of a piece
+	std::vector<int> readAxis(const std::string &);
+
+	// Throws a std::runtime_error for the given line, by default the current one
+	void fail(const std::string &, int line = 0) const;
+};
+
+// Writes a puzzle in the format read by puzzleReader
+std::ostream &operator<< (std::ostream &, const puzzleDefinition &);
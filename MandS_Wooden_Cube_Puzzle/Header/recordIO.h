@@ -0,0 +1,46 @@
+#pragma once
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/* Helpers for the small text files the solver writes, such as checkpoints
+and shard results: one named field per line, lists being prefixed by
+their size. Reading throws std::runtime_error naming the field which is
+missing or malformed, for the caller to add which file it was.*/
+
+// Writes a named list of values on one line
+template <typename T>
+void writeList(std::ostream &os, const char *name, const std::vector<T> &values) {
+	os << name << " " << values.size();
+	for (int i = 0; i < (int)values.size(); ++i) {
+		os << " " << values[i];
+	}
+	os << std::endl;
+}
+
+// Reads the next value, checking it follows the expected name
+template <typename T>
+void readField(std::istream &is, const char *name, T &value) {
+	std::string found;
+	if (!(is >> found) || found != name || !(is >> value)) {
+		throw std::runtime_error(std::string("expected \"") + name + "\"");
+	}
+}
+
+// Reads a list written by writeList()
+template <typename T>
+void readList(std::istream &is, const char *name, std::vector<T> &values) {
+	int size;
+	readField(is, name, size);
+	if (size < 0 || size > 4096) {
+		throw std::runtime_error(std::string("bad size for \"") + name + "\"");
+	}
+	values.resize(size);
+	for (int i = 0; i < size; ++i) {
+		if (!(is >> values[i])) {
+			throw std::runtime_error(std::string("short \"") + name + "\"");
+		}
+	}
+}
\ No newline at end of file
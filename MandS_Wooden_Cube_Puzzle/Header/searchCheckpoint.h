@@ -0,0 +1,48 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "cellMask.h"
+#include "searchStats.h"
+
+/* The position of an interrupted search, written periodically by cubeSolver
+so that a later run of the same puzzle with the same options can carry on
+exactly where it stopped. The search is recursive, so its position is the
+index reached by the loop at each depth: the search was about to enter
+depth, having made the placement at cursor[i] at every shallower depth i.
+The reference search also records the distinct orientation it had fixed
+for every piece. Saved as a short text file of one field per line.*/
+struct searchCheckpoint {
+
+	// Identifies the puzzle and search options the checkpoint belongs to
+	unsigned long long fingerprint;
+
+	// Whether the search had finished, in which case there is nothing
+	// left to search and only the results are restored
+	bool complete;
+
+	int depth;
+	std::vector<int> cursor;
+	std::vector<int> orientations;
+
+	// Whether a solution was found and, if so, the mask each piece occupies
+	bool solved;
+	std::vector<cellMask> placedMasks;
+
+	long long int solutions;
+	double elapsedSeconds;
+	double firstSolutionSeconds;
+	searchStats stats;
+
+	searchCheckpoint();
+
+	// Writes the checkpoint to a file by way of a temporary file, so that
+	// being interrupted part way through leaves the previous checkpoint
+	// intact. Returns false if the file cannot be written.
+	bool save(const std::string &) const;
+
+	// Reads a checkpoint file, returning false if there is none.
+	// Throws std::runtime_error if the file is malformed.
+	bool load(const std::string &);
+};
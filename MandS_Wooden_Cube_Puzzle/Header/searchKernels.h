@@ -0,0 +1,48 @@
+#pragma once
+
+#include "cellMask.h"
+#include "boxDimensions.h"
+
+// The instruction sets the batch overlap test is written for
+enum instructionSet { scalarInstructions, sse2Instructions, avx2Instructions };
+
+// Tests up to 64 consecutive placement masks against the grid, returning
+// a bitmap with bit i set when the i-th mask does not overlap the grid
+typedef unsigned long long (*fitMasksFunction)(const cellMask *, int, cellMask);
+
+/* The search's hot loops over every position of the box, gathered as
+function pointers so that one binary serves every box size. For common
+box sizes they point at template instantiations whose dimensions are
+known at compile time, letting the compiler fully unroll the loops.
+Boxes of any other size get versions reading the dimensions at runtime.
+The batch overlap test is instead chosen by the instructions the
+processor supports when the kernels are selected.*/
+struct searchKernels {
+
+	// Returns the empty position (set within the mask) with the fewest
+	// candidates, or -1 if no position is empty
+	int (*mostConstrainedCell)(cellMask, const int *, const boxDimensions &);
+
+	// Grows a region (the first mask) through the face-adjacent positions
+	// of the empty mask until it is the whole connected region holding it
+	cellMask (*growRegion)(cellMask, cellMask, const boxDimensions &);
+
+	// Tests a block of placement masks against the grid at once
+	fitMasksFunction fitMasks;
+
+	// True when the kernels are compile-time instantiations
+	bool fixedSize;
+
+	// The instruction set fitMasks uses
+	instructionSet fitMasksInstructions;
+};
+
+// Selects the kernels for a box
+searchKernels selectKernels(const boxDimensions &);
+
+// The batch overlap test written for an instruction set, or null when
+// neither this build nor the processor supports it
+fitMasksFunction fitMasksFor(instructionSet);
+
+// The name of an instruction set, e.g. "AVX2"
+const char *instructionSetName(instructionSet);
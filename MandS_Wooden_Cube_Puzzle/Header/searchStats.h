@@ -0,0 +1,122 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+
+// Build with SEARCH_STATS defined as 0 (e.g. -DSEARCH_STATS=0) to compile
+// the counters and progress reports out of the search entirely
+#ifndef SEARCH_STATS
+#define SEARCH_STATS 1
+#endif
+
+/* Counters kept per search depth whilst solving. A node is one visit to a
+depth, a rejection a placement refused because it overlaps the grid (or,
+for the constrained search, a position nothing can fill any more), a
+placement one made, a prune a placement taken straight back off because
+the empty space it leaves cannot be filled and a backtrack one taken back
+off after searching beneath it. Table hits and misses count lookups of
+the depth's state in the transposition table. The counting methods are
+inline and do nothing when SEARCH_STATS is 0, so the search pays nothing
+for them when disabled.*/
+class searchStats {
+
+	struct depthStats {
+		long long int nodes;
+		long long int rejections;
+		long long int placements;
+		long long int prunes;
+		long long int backtracks;
+		long long int tableHits;
+		long long int tableMisses;
+	};
+
+	std::vector<depthStats> depths;
+
+public:
+
+	// Zero every counter, keeping room for the given number of depths
+	void reset(int);
+
+	// Add the counters of another search, e.g. a parallel worker. The depths
+	// below sharedDepths were walked alike by both, e.g. shards of one
+	// search, so keep the larger of their counters instead of adding.
+	void merge(const searchStats &, int sharedDepths = 0);
+
+	void node(int depth) {
+#if SEARCH_STATS
+		depths[depth].nodes++;
+#else
+		(void)depth;
+#endif
+	}
+
+	// Rejections may be counted in a local first and added in bulk,
+	// keeping the store out of the tightest loops
+	void rejection(int depth, int howMany = 1) {
+#if SEARCH_STATS
+		depths[depth].rejections += howMany;
+#else
+		(void)depth; (void)howMany;
+#endif
+	}
+
+	void placement(int depth) {
+#if SEARCH_STATS
+		depths[depth].placements++;
+#else
+		(void)depth;
+#endif
+	}
+
+	void prune(int depth) {
+#if SEARCH_STATS
+		depths[depth].prunes++;
+#else
+		(void)depth;
+#endif
+	}
+
+	void backtrack(int depth) {
+#if SEARCH_STATS
+		depths[depth].backtracks++;
+#else
+		(void)depth;
+#endif
+	}
+
+	void tableLookup(int depth, bool hit) {
+#if SEARCH_STATS
+		if (hit) {
+			depths[depth].tableHits++;
+		}
+		else {
+			depths[depth].tableMisses++;
+		}
+#else
+		(void)depth; (void)hit;
+#endif
+	}
+
+	// The number of depths counted
+	int noOfDepths() const;
+
+	// Totals over every depth
+	long long int totalNodes() const;
+	long long int totalRejections() const;
+	long long int totalPlacements() const;
+	long long int totalPrunes() const;
+	long long int totalBacktracks() const;
+	long long int totalTableHits() const;
+	long long int totalTableMisses() const;
+
+	// Prints a single JSON line of progress after the given seconds
+	void printProgress(std::ostream &, double, long long int) const;
+
+	// Prints one JSON line of counters per depth
+	void printDepths(std::ostream &) const;
+
+	// Saves and restores every counter, for checkpoints. read() returns
+	// false if the stream does not hold what write() wrote.
+	void write(std::ostream &) const;
+	bool read(std::istream &);
+};
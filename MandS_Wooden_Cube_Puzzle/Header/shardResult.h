@@ -0,0 +1,56 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "cellMask.h"
+#include "boxDimensions.h"
+#include "searchStats.h"
+
+/* What one shard of a sharded search (see cubeSolver::setShard()) found,
+written by each shard's process as a short text file of one field per
+line and combined afterwards by merge(). Shards of the same search share
+a fingerprint and shard count. Solutions are only kept when asked for,
+each as the mask of every piece in order of addition, so that the piece
+ids are enough to print them.*/
+struct shardResult {
+
+	// Which shard (0 to count - 1) of how many
+	int index;
+	int count;
+
+	// Identifies the puzzle and search options, see cubeSolver::fingerprint()
+	unsigned long long fingerprint;
+
+	boxDimensions box;
+	std::vector<int> ids;
+
+	long long int solutions;
+
+	// The seconds the shard took and took to find its first solution
+	// (negative if none). Merged results hold the longest shard, the sum
+	// over every shard and the earliest first solution.
+	double elapsedSeconds;
+	double totalSeconds;
+	double firstSolutionSeconds;
+
+	// The depths every shard counts alike, see cubeSolver::noOfSharedDepths()
+	int sharedDepths;
+	searchStats stats;
+
+	// The solutions kept, shard by shard once merged
+	std::vector<std::vector<cellMask> > kept;
+
+	shardResult();
+
+	// Writes the result to a file, returning false if it cannot be written
+	bool save(const std::string &) const;
+
+	// Reads a result file. Throws std::runtime_error if the file cannot be
+	// read or is malformed.
+	void load(const std::string &);
+
+	// Adds another shard of the same search. Throws std::runtime_error if
+	// it belongs to another search.
+	void merge(const shardResult &);
+};
\ No newline at end of file
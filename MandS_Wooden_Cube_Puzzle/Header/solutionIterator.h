@@ -0,0 +1,92 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include "cubeSolver.h"
+#include "cellMask.h"
+
+/* Pull-based alternative to cubeSolver::solve() handing back one solution
+at a time. The interleaved search runs on an explicit stack rather than by
+recursion, so it can stop after any number of nodes and later carry on
+exactly where it left off. Callers may take only the first few solutions,
+bound the work done by each call or step several puzzles in turn on one
+thread, with one solutionIterator per puzzle.
+
+Construction copies a solver with every piece added, keeping its symmetry
+breaking and pruning options. Whatever its search mode the interleaved
+search is used, on a single thread and without the transposition table,
+shards or checkpoints.*/
+class solutionIterator {
+
+	// The search state of one level: the block of 64 placements being
+	// tested, those of them which fit the grid and are yet to be tried, and
+	// the marked positions of each colouring left to cover on entry
+	struct frame {
+		int block;
+		unsigned long long fits;
+		int needed[cubeSolver::maxColourings];
+	};
+
+	// The copy of the solver searched, holding the grid, placements and counters
+	cubeSolver solver;
+
+	// One frame per level being searched, the deepest last
+	std::vector<frame> stack;
+
+	// The placement index chosen for each placed piece by order of addition
+	std::vector<int> indices;
+
+	// Whether the search has started, whether it has searched everything
+	// and whether a solution is held, to be taken back off by advance()
+	bool started;
+	bool exhausted;
+	bool holding;
+
+	// False if no solution can exist, see cubeSolver::prepareSearch()
+	bool balanced;
+
+	// Nodes visited by the current call to advance()
+	long long int visited;
+
+public:
+
+	friend std::ostream &operator<< (std::ostream &, const solutionIterator &);
+
+	// Constructor taking in the solver, with every piece added, to search
+	solutionIterator(const cubeSolver &);
+
+	// Searches on to the next solution, returning true once one is held.
+	// Returns false once the search is exhausted or, if nodeBudget is not
+	// negative, after visiting that many nodes without finding one. A later
+	// call then carries on from where this one stopped.
+	bool advance(long long int nodeBudget = -1);
+
+	// True once every solution has been handed back
+	bool isExhausted() const;
+
+	// The index of each piece's placement in the solution held, counting
+	// the placements of that piece in the order the placement table holds them
+	const std::vector<int> &getPlacementIndices() const;
+
+	// The mask each piece occupies in the solution held
+	const std::vector<cellMask> &getPlacedMasks() const;
+
+	// The orientation (0 to 23) and location of a piece in the solution held
+	int getOrientation(int) const;
+
+	int getLocation(int) const;
+
+	// The number of solutions handed back so far
+	long long int noOfSolutions() const;
+
+	// The number of nodes visited so far
+	long long int noOfIterations() const;
+
+private:
+
+	// Starts searching the placements of the piece at the given level
+	void enter(int);
+};
+
+// Prints the solution held in the same layout as cubeSolver
+std::ostream &operator<< (std::ostream &, const solutionIterator &);
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include "cellMask.h"
+#include "wrappedPiece.h"
+#include "boxDimensions.h"
+
+/* Interface receiving each solution as soon as the solver finds it, so that
+solutions are never held in memory. A solution is given as the box and the
+mask each piece occupies, with a 1-to-1 correspondence with the wrapped pieces in
+their order of addition. When solving on several threads calls are
+serialised by the solver.*/
+class solutionSink {
+
+public:
+
+	virtual ~solutionSink() {}
+
+	virtual void addSolution(const boxDimensions &, const std::vector<cellMask> &, const std::vector<wrappedPiece> &) = 0;
+};
+
+/* Sink printing each solution to an output stream in the same layout as
+the solvers' operator<<, numbering them as they arrive.*/
+class streamSink : public solutionSink {
+
+	std::ostream &os;
+
+	// Solutions printed so far
+	long long int count;
+
+public:
+
+	streamSink(std::ostream &);
+
+	virtual void addSolution(const boxDimensions &, const std::vector<cellMask> &, const std::vector<wrappedPiece> &);
+};
+
+/* Sink keeping every solution in memory as the mask each piece occupies,
+for when they must all be written out together.*/
+class collectingSink : public solutionSink {
+
+	std::vector<std::vector<cellMask> > solutions;
+
+public:
+
+	virtual void addSolution(const boxDimensions &, const std::vector<cellMask> &, const std::vector<wrappedPiece> &);
+
+	// The solutions received, in order of arrival
+	const std::vector<std::vector<cellMask> > &getSolutions() const;
+};
\ No newline at end of file
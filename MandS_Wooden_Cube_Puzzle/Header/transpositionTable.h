@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include "cellMask.h"
+
+/* Fixed-size hash table of search states proven to have no completion. A
+state is the occupied positions of the grid together with the set of
+pieces still to be placed, one bit per piece by order of addition. Each
+slot holds one state as cellMaskWords + 1 words, the last packing the
+piece set with the number of pieces remaining and the others holding the
+words of the grid XORed with the last and with the hash of the whole
+state. Parallel workers may share a table without locking: the words are
+written separately, so a slot torn by two writers no longer matches
+either state and simply reads as a miss.*/
+class transpositionTable {
+
+public:
+
+	// Which state is kept when two states want the same slot:
+	// - replaceAlways always keeps the newest.
+	// - replaceShallower only replaces a state with at most as many pieces
+	//   remaining, keeping the states whose subtrees cost the most to search.
+	enum replacementPolicy { replaceAlways, replaceShallower };
+
+	// The piece set occupies the low bits of a slot's second word
+	static const int maxPieces = 48;
+
+private:
+
+	// log2 of the number of slots
+	int sizeBits;
+
+	replacementPolicy policy;
+
+	// The words of each slot
+	static const int slotWords = cellMaskWords + 1;
+
+	// slotWords words per slot, allocated by clear()
+	std::unique_ptr<std::atomic<unsigned long long>[]> slots;
+	int allocatedBits;
+
+public:
+
+	// Constructor taking in log2 of the number of slots and the policy
+	transpositionTable(int bits = 20, replacementPolicy toUse = replaceShallower);
+
+	// Copies only the size and policy, never the states held
+	transpositionTable(const transpositionTable &);
+	transpositionTable &operator=(const transpositionTable &);
+
+	// Change the size and policy, taking effect at the next clear()
+	transpositionTable &configure(int, replacementPolicy);
+
+	// Forget every state, allocating the slots on first use
+	void clear();
+
+	// The number of slots and how many currently hold a state
+	long long int noOfSlots() const;
+	long long int noOfUsedSlots() const;
+
+	// True if the state was recorded as having no completion
+	bool contains(const cellMask &occupied, unsigned long long remaining) const {
+		unsigned long long hash = hashOf(occupied, remaining);
+		const std::atomic<unsigned long long> *slot = &slots[slotWords * indexOf(hash)];
+		unsigned long long data = slot[cellMaskWords].load(std::memory_order_relaxed);
+		if ((data & pieceBits) != remaining) {
+			return false;
+		}
+		for (int word = 0; word < cellMaskWords; ++word) {
+			if ((slot[word].load(std::memory_order_relaxed) ^ data ^ hash) != maskWord(occupied, word)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Records a state as having no completion, subject to the policy
+	void insert(const cellMask &, unsigned long long);
+
+private:
+
+	static const unsigned long long pieceBits = (1ULL << maxPieces) - 1;
+
+	// Hashes a state, mixing in one word of the grid at a time
+	static unsigned long long hashOf(const cellMask &occupied, unsigned long long remaining) {
+		unsigned long long hash = remaining * 0x9E3779B97F4A7C15ULL;
+		for (int word = 0; word < cellMaskWords; ++word) {
+			hash = (hash ^ maskWord(occupied, word)) * 0xBF58476D1CE4E5B9ULL;
+		}
+		return hash ^ (hash >> 31);
+	}
+
+	// The slot a hash selects
+	long long int indexOf(unsigned long long hash) const {
+		return (long long int)(hash >> (64 - allocatedBits));
+	}
+};
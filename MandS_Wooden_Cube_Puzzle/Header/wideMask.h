@@ -0,0 +1,204 @@
+#pragma once
+
+#include <iostream>
+
+/* A set of box positions spread over N 64-bit words, used as the cellMask
+of boxes holding more than 64 positions (see cellMask.h). Position i is
+bit i % 64 of word i / 64, so the words lie in memory as one wide
+little-endian integer which SIMD instructions load as is. Supports the
+bitwise operators and shifts of a built-in integer, shifts carrying bits
+across words, so that the search code is shared with the single word
+cellMask. Every operation is a fixed loop over the words which the
+compiler unrolls.*/
+template <int N>
+struct wideMask {
+
+	unsigned long long words[N];
+
+	// An empty mask, or one holding the positions of the lowest word
+	constexpr wideMask(unsigned long long low = 0) : words{ low } {}
+
+	constexpr wideMask &operator&=(const wideMask &other) {
+		for (int i = 0; i < N; ++i) {
+			words[i] &= other.words[i];
+		}
+		return *this;
+	}
+
+	constexpr wideMask &operator|=(const wideMask &other) {
+		for (int i = 0; i < N; ++i) {
+			words[i] |= other.words[i];
+		}
+		return *this;
+	}
+
+	constexpr wideMask &operator^=(const wideMask &other) {
+		for (int i = 0; i < N; ++i) {
+			words[i] ^= other.words[i];
+		}
+		return *this;
+	}
+
+	constexpr wideMask operator~() const {
+		wideMask result;
+		for (int i = 0; i < N; ++i) {
+			result.words[i] = ~words[i];
+		}
+		return result;
+	}
+
+	// Moves every position up by shift, positions moved past the top are lost
+	constexpr wideMask operator<<(int shift) const {
+		wideMask result;
+		int wordShift = shift / 64, bitShift = shift % 64;
+		for (int i = N - 1; i >= wordShift; --i) {
+			result.words[i] = words[i - wordShift] << bitShift;
+			if (bitShift != 0 && i - wordShift > 0) {
+				result.words[i] |= words[i - wordShift - 1] >> (64 - bitShift);
+			}
+		}
+		return result;
+	}
+
+	// Moves every position down by shift, positions moved past 0 are lost
+	constexpr wideMask operator>>(int shift) const {
+		wideMask result;
+		int wordShift = shift / 64, bitShift = shift % 64;
+		for (int i = 0; i + wordShift < N; ++i) {
+			result.words[i] = words[i + wordShift] >> bitShift;
+			if (bitShift != 0 && i + wordShift + 1 < N) {
+				result.words[i] |= words[i + wordShift + 1] << (64 - bitShift);
+			}
+		}
+		return result;
+	}
+
+	// Defined as friends so that 0 converts to a mask, as in mask != 0
+	friend constexpr wideMask operator&(wideMask a, const wideMask &b) {
+		return a &= b;
+	}
+
+	friend constexpr wideMask operator|(wideMask a, const wideMask &b) {
+		return a |= b;
+	}
+
+	friend constexpr wideMask operator^(wideMask a, const wideMask &b) {
+		return a ^= b;
+	}
+
+	friend constexpr bool operator==(const wideMask &a, const wideMask &b) {
+		unsigned long long differ = 0;
+		for (int i = 0; i < N; ++i) {
+			differ |= a.words[i] ^ b.words[i];
+		}
+		return differ == 0;
+	}
+
+	friend constexpr bool operator!=(const wideMask &a, const wideMask &b) {
+		return !(a == b);
+	}
+
+	// Orders masks as the wide integers they are, the highest word first
+	friend constexpr bool operator<(const wideMask &a, const wideMask &b) {
+		for (int i = N - 1; i >= 0; --i) {
+			if (a.words[i] != b.words[i]) {
+				return a.words[i] < b.words[i];
+			}
+		}
+		return false;
+	}
+
+	friend constexpr bool operator>(const wideMask &a, const wideMask &b) {
+		return b < a;
+	}
+
+	friend constexpr bool operator<=(const wideMask &a, const wideMask &b) {
+		return !(b < a);
+	}
+
+	friend constexpr bool operator>=(const wideMask &a, const wideMask &b) {
+		return !(a < b);
+	}
+};
+
+// True if the two masks share at least one cell
+template <int N>
+inline bool overlaps(const wideMask<N> &a, const wideMask<N> &b) {
+	unsigned long long shared = 0;
+	for (int i = 0; i < N; ++i) {
+		shared |= a.words[i] & b.words[i];
+	}
+	return shared != 0;
+}
+
+// Returns the number of cells set within a mask
+template <int N>
+inline int cellCount(const wideMask<N> &mask) {
+	int count = 0;
+	for (int i = 0; i < N; ++i) {
+		count += cellCount(mask.words[i]);
+	}
+	return count;
+}
+
+// Returns the index of the lowest cell set within a non-empty mask
+template <int N>
+inline int lowestCell(const wideMask<N> &mask) {
+	int i = 0;
+	while (mask.words[i] == 0) {
+		++i;
+	}
+	return 64 * i + lowestCell(mask.words[i]);
+}
+
+// Returns a non-empty mask without its lowest cell
+template <int N>
+inline wideMask<N> withoutLowestCell(wideMask<N> mask) {
+	int i = 0;
+	while (mask.words[i] == 0) {
+		++i;
+	}
+	mask.words[i] &= mask.words[i] - 1;
+	return mask;
+}
+
+// Returns a mask holding only the lowest cell of a non-empty mask
+template <int N>
+inline wideMask<N> lowestCellOnly(const wideMask<N> &mask) {
+	wideMask<N> lowest;
+	int i = 0;
+	while (mask.words[i] == 0) {
+		++i;
+	}
+	lowest.words[i] = mask.words[i] & (0 - mask.words[i]);
+	return lowest;
+}
+
+// True if the mask holds the given cell index
+template <int N>
+constexpr bool hasCell(const wideMask<N> &mask, int cell) {
+	return ((mask.words[cell / 64] >> (cell % 64)) & 1) != 0;
+}
+
+// The word-th 64 positions of a mask
+template <int N>
+inline unsigned long long maskWord(const wideMask<N> &mask, int word) {
+	return mask.words[word];
+}
+
+// Writes the words lowest first, separated by spaces
+template <int N>
+std::ostream &operator<< (std::ostream &os, const wideMask<N> &mask) {
+	for (int i = 0; i < N; ++i) {
+		os << (i == 0 ? "" : " ") << mask.words[i];
+	}
+	return os;
+}
+
+template <int N>
+std::istream &operator>> (std::istream &is, wideMask<N> &mask) {
+	for (int i = 0; i < N; ++i) {
+		is >> mask.words[i];
+	}
+	return is;
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+/* Class running tasks on a fixed number of worker threads. Each worker
+owns a queue of tasks, taking work from the back of its own queue and,
+once that is empty, stealing from the front of another worker's queue.
+Submit all tasks first, then call run() which returns once every task
+has completed. Each task is passed the index of the worker running it,
+allowing per-worker state to be kept without locking.*/
+class workStealingPool {
+
+	// A worker's own queue of tasks
+	struct taskQueue {
+		std::mutex lock;
+		std::deque<std::function<void(int)> > tasks;
+	};
+
+	std::vector<taskQueue> queues;
+
+	// The queue the next submitted task is given to
+	int nextQueue;
+
+public:
+
+	// Constructor taking in the number of worker threads
+	workStealingPool(int);
+
+	int noOfThreads() const;
+
+	// Queue a task, spreading tasks evenly over the workers
+	void submit(const std::function<void(int)> &);
+
+	// Runs every submitted task, blocking until all have completed
+	void run();
+
+private:
+
+	// Runs tasks for a single worker until no queue holds any more
+	void workerLoop(int);
+
+	// Takes a task from the worker's own queue, or failing that steals
+	// one from another worker. Returns false once every queue is empty.
+	bool takeTask(int, std::function<void(int)> &);
+};
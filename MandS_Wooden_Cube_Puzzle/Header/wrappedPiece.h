@@ -4,9 +4,7 @@
 #include <vector>
 #include "element.h"
 #include "piece.h"
-
-// Define the size of the cube, i.e. SIZE = 3 means a 3 x 3 x 3 cube
-#define SIZE 3
+#include "boxDimensions.h"
 
 /* Class wrappedPiece wraps a plain piece, originalPiece, and provides mechanisms
 to obtain rotations and shifts of the originalPiece, through outputs
@@ -21,27 +19,44 @@ class wrappedPiece {
 
 	piece originalPiece, orientatedPiece, locatedPiece;
 
-	// Re-using element class to store possible locations/shifts 
-	// (This is really a misuse of the element class' intended purpose)
-	std::vector<element> locations;
+	// The box the piece must stay within
+	boxDimensions box;
 
-	// Direction enum along x, y, or z axis
-	enum direction { dirx, diry, dirz };
+	// How far orientatedPiece may be shifted along each axis whilst staying
+	// inside the box. Rather than being stored, each location/shift is
+	// worked out from its number, the z shift changing fastest.
+	int maxShifts[3];
 
-	// TODO: Arrays may be less bulky than vector<vector<int> >
-	// Rotation matrices along x-axis, y-axis and z-axis
-	std::vector<std::vector<int> > rotmatx, rotmaty, rotmatz;
+	// The orientations (0 to 23) which produce distinct shapes. Symmetric
+	// pieces look identical under some rotations, only the first
+	// orientation of each such group is kept.
+	int distinctOrientations[24];
+	int noOfDistinctOrientations;
 
 public:
 
-	// Constructor taking in toWrap which is the originalPiece
-	// We also setup our rotation matrices: rotmatx, rotmaty and rotmatz.
-	wrappedPiece(const piece &);
+	// Times the private hot paths
+	friend class solverBenchmark;
+
+	// Constructor taking in toWrap which is the originalPiece and the box it must stay within.
+	wrappedPiece(const piece &, const boxDimensions &);
 
 	int getId() const;
 
+	// The number of elements making up the piece
+	int size() const;
+
 	int noOfLocations();
 
+	// The number of orientations producing a distinct shape
+	int noOfOrientations() const;
+
+	// Returns the i-th distinct orientation, in the range 0 to 23
+	int getOrientation(int) const;
+
+	// The number of orientations discarded as duplicates of another
+	int noOfDuplicateOrientations() const;
+
 	void printOrientatedPiece(std::ostream &) const;
 
 	void printLocatedPiece(std::ostream &) const;
@@ -56,12 +71,21 @@ public:
 	// to a square. This gives a total of 6 x 4 = 24 possibilities.  
 	piece &orientatePiece(int);
 
+	// Applies the rotations of an orientation (0 to 23) to a single element
+	// about the origin, without moving the result back to the origin. The
+	// 24 rotations are worked out at compile time.
+	static element orientateElement(int, const element &);
+
 	// This shifts intermediate orientatedPiece to produce final output locatedPiece.
-	// Argument location should be within the range 0 to locations.size().
+	// Argument location should be within the range 0 to noOfLocations().
 	piece &relocatePiece(int);
 
 private:
 
+	// Sets orientatedPiece to the originalPiece in an orientation (0 to 23),
+	// moved back to the origin, leaving the locations untouched
+	void applyOrientation(int);
+
 	// Returns the lowest occupied position by the orientatedPiece
 	// along the dir axis
 	int getMinPosition(int) const;
@@ -70,17 +94,19 @@ private:
 	// along the dir axis
 	int getMaxPosition(int) const;
 
-	// After rotatePiece() has been called it may nolonger start at the origin.
+	// After the piece has been rotated it may nolonger start at the origin.
 	// This relocated the piece to start at the origin, ie. the minimum position 
 	// occupied by the piece along all 3 major axis is 0. In particular this
 	// ensure that the rotated piece remains inside the cube.
 	void startAtOrigin();
 
-	// Rotate an element using matrix multiplications with a rotation matrix.
-	void rotateElement(const std::vector<std::vector<int> > &, element &);
+	// Writes the elements of orientatedPiece sorted and packed into integers,
+	// one per element. Two orientations produce the same shape exactly when
+	// these are equal.
+	void canonicalOrientation(int *) const;
 
-	// Rotate a piece by rotating each element in turn.
-	void rotatePiece(direction, int);
+	// Fills distinctOrientations by hashing the canonical form of all 24 orientations
+	void findDistinctOrientations();
 
 	// After a piece has been orientated we recalculate how it can be
 	// shifted along each of the 3 major axis. The number of possible
@@ -2,7 +2,11 @@ C:
 
 cd C:\Users\AnthonyDas\Documents\GitHub\MandS_Wooden_Cube_Puzzle\MandS_Wooden_Cube_Puzzle\
 
-g++ -Wall -Wconversion -g -mtune=native -O3 -I"C:\Users\AnthonyDas\Documents\GitHub\MandS_Wooden_Cube_Puzzle\MandS_Wooden_Cube_Puzzle\Header" main.cpp cubeSolver.cpp wrappedPiece.cpp piece.cpp element.cpp -o main.exe
+g++ -Wall -Wconversion -g -mtune=native -O3 -pthread -I"C:\Users\AnthonyDas\Documents\GitHub\MandS_Wooden_Cube_Puzzle\MandS_Wooden_Cube_Puzzle\Header" main.cpp cubeSolver.cpp wrappedPiece.cpp piece.cpp element.cpp placementTable.cpp dlxSolver.cpp workStealingPool.cpp solutionSink.cpp boxDimensions.cpp searchKernels.cpp puzzleLoader.cpp searchStats.cpp transpositionTable.cpp searchCheckpoint.cpp shardResult.cpp puzzleGenerator.cpp solutionIterator.cpp -o main.exe
+
+g++ -Wall -Wconversion -g -mtune=native -O3 -pthread -DMAX_BOX_CELLS=216 -I"C:\Users\AnthonyDas\Documents\GitHub\MandS_Wooden_Cube_Puzzle\MandS_Wooden_Cube_Puzzle\Header" main.cpp cubeSolver.cpp wrappedPiece.cpp piece.cpp element.cpp placementTable.cpp dlxSolver.cpp workStealingPool.cpp solutionSink.cpp boxDimensions.cpp searchKernels.cpp puzzleLoader.cpp searchStats.cpp transpositionTable.cpp searchCheckpoint.cpp shardResult.cpp puzzleGenerator.cpp solutionIterator.cpp -o main_wide.exe
+
+g++ -Wall -Wconversion -g -mtune=native -O3 -pthread -I"C:\Users\AnthonyDas\Documents\GitHub\MandS_Wooden_Cube_Puzzle\MandS_Wooden_Cube_Puzzle\Header" benchmark.cpp cubeSolver.cpp wrappedPiece.cpp piece.cpp element.cpp placementTable.cpp dlxSolver.cpp workStealingPool.cpp solutionSink.cpp boxDimensions.cpp searchKernels.cpp puzzleLoader.cpp searchStats.cpp transpositionTable.cpp searchCheckpoint.cpp shardResult.cpp puzzleGenerator.cpp solutionIterator.cpp -o benchmark.exe
 
 
 pause
@@ -0,0 +1,359 @@
+/*Benchmarks for the solver hot paths.
+
+Compile using g++ with the same sources as main.exe, except main.cpp:
+
+g++ -Wall -Wconversion -g -mtune=native -O3 -pthread
+-I" .\MandS_Wooden_Cube_Puzzle\MandS_Wooden_Cube_Puzzle\Header"
+benchmark.cpp cubeSolver.cpp wrappedPiece.cpp piece.cpp element.cpp ... -o benchmark.exe
+
+Adding -DMAX_BOX_CELLS=216 also benchmarks 5 x 5 x 5 and 6 x 6 x 6 puzzles
+with the wide cellMask (see cellMask.h).
+
+Every result is printed as one JSON object per line so that the output of
+two builds can be compared mechanically. Micro-benchmarks report ns_per_op,
+end-to-end solves report nodes_per_sec and time_to_first_solution_s.
+*/
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "piece.h"
+#include "wrappedPiece.h"
+#include "cubeSolver.h"
+#include "dlxSolver.h"
+#include "boxDimensions.h"
+#include "searchKernels.h"
+#include "puzzleGenerator.h"
+#include "solutionIterator.h"
+
+// The minimum time spent repeating each micro-benchmark
+static const double minSeconds = 0.25;
+
+// Stops the compiler discarding benchmarked work
+static volatile long long int consumed = 0;
+
+/* Class with access to the private hot paths of wrappedPiece and cubeSolver.*/
+class solverBenchmark {
+
+public:
+
+	static void orientatePiece(const piece &);
+
+	static void relocatePiece(const piece &);
+
+	static void orientateElement();
+
+	static void constructPiece(const piece &);
+
+	static void addAndRemovePiece(const std::vector<piece> &);
+
+	// Times the batch overlap test for an instruction set, per mask tested
+	static void fitMasks(const std::vector<piece> &, instructionSet);
+
+	// Solves a puzzle from scratch, including building its placement table,
+	// with a transposition table of 2^tableBits slots if tableBits is not 0
+	static void solve(const std::string &, const boxDimensions &, const std::vector<piece> &,
+		cubeSolver::searchMode, bool, bool, int tableBits = 0);
+
+	static void solveDlx(const std::string &, const boxDimensions &, const std::vector<piece> &);
+
+	// Takes every solution from a solutionIterator, giving each call to
+	// advance() a budget of the given number of nodes, and reports the
+	// longest call as well as the totals
+	static void iterate(const std::string &, const boxDimensions &, const std::vector<piece> &, bool, long long int);
+
+	// Generates the given number of puzzles with a unique solution, splitting
+	// the box into pieces of the given size and checking them with a search mode
+	static void generate(const std::string &, const boxDimensions &, int, int, cubeSolver::searchMode);
+
+private:
+
+	// Prints a micro-benchmark result
+	static void report(const std::string &, long long int, double);
+};
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void solverBenchmark::report(const std::string &name, long long int operations, double seconds) {
+	std::cout << "{\"benchmark\":\"" << name << "\",\"operations\":" << operations
+		<< ",\"seconds\":" << seconds << ",\"ns_per_op\":" << seconds * 1e9 / (double)operations << "}" << std::endl;
+}
+
+void solverBenchmark::orientatePiece(const piece &toWrap) {
+	wrappedPiece wrapped(toWrap, boxDimensions());
+	long long int operations = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	do {
+		for (int orientation = 0; orientation < 24; ++orientation) {
+			consumed += wrapped.orientatePiece(orientation).size();
+		}
+		operations += 24;
+	} while (secondsSince(start) < minSeconds);
+	report("wrappedPiece::orientatePiece", operations, secondsSince(start));
+}
+
+void solverBenchmark::relocatePiece(const piece &toWrap) {
+	wrappedPiece wrapped(toWrap, boxDimensions());
+	wrapped.orientatePiece(0);
+	long long int operations = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	do {
+		for (int location = 0; location < wrapped.noOfLocations(); ++location) {
+			consumed += wrapped.relocatePiece(location).getElement(0).get(0);
+		}
+		operations += wrapped.noOfLocations();
+	} while (secondsSince(start) < minSeconds);
+	report("wrappedPiece::relocatePiece", operations, secondsSince(start));
+}
+
+void solverBenchmark::orientateElement() {
+	element toRotate(1, 2, 0);
+	long long int operations = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	do {
+		for (int orientation = 0; orientation < 24; ++orientation) {
+			consumed += wrappedPiece::orientateElement(orientation, toRotate).get(0);
+		}
+		operations += 24;
+	} while (secondsSince(start) < minSeconds);
+	report("wrappedPiece::orientateElement", operations, secondsSince(start));
+}
+
+void solverBenchmark::constructPiece(const piece &toWrap) {
+	long long int operations = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	do {
+		wrappedPiece wrapped(toWrap, boxDimensions());
+		consumed += wrapped.noOfOrientations();
+		operations++;
+	} while (secondsSince(start) < minSeconds);
+	report("wrappedPiece::wrappedPiece", operations, secondsSince(start));
+}
+
+void solverBenchmark::addAndRemovePiece(const std::vector<piece> &pieces) {
+	cubeSolver cube;
+	cube.setVerbose(false);
+	for (int i = 0; i < (int)pieces.size(); ++i) {
+		cube.addPiece(pieces[i]);
+	}
+	cube.placements.build(cube.wrappedPieces, cube.box);
+
+	// Alternate between an empty grid and one holding the first piece so
+	// that both the fitting and the overlapping case are timed
+	cube.clearGrid();
+	long long int operations = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	do {
+		for (int index = 0; index < cube.placements.noOfPlacements(1); ++index) {
+			if (cube.addPieceToGrid(1, cube.placements.getMask(1, index))) {
+				cube.removePiece(1);
+			}
+		}
+		operations += cube.placements.noOfPlacements(1);
+		if (cube.placedMasks[0] == 0) {
+			cube.addPieceToGrid(0, cube.placements.getMask(0, 0));
+		}
+		else {
+			cube.removePiece(0);
+		}
+	} while (secondsSince(start) < minSeconds);
+	consumed += (long long int)cellCount(cube.grid);
+	report("cubeSolver::addPieceToGrid+removePiece", operations, secondsSince(start));
+}
+
+void solverBenchmark::fitMasks(const std::vector<piece> &pieces, instructionSet instructions) {
+	fitMasksFunction test = fitMasksFor(instructions);
+	if (test == 0) {
+		return; // Not supported here
+	}
+
+	cubeSolver cube;
+	cube.setVerbose(false);
+	for (int i = 0; i < (int)pieces.size(); ++i) {
+		cube.addPiece(pieces[i]);
+	}
+	cube.placements.build(cube.wrappedPieces, cube.box);
+
+	// Test the second piece's placements against the first piece
+	const cellMask *masks = cube.placements.getMasks(1);
+	int count = cube.placements.noOfPlacements(1);
+	cellMask grid = cube.placements.getMask(0, 0);
+	long long int operations = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	do {
+		for (int block = 0; block < count; block += 64) {
+			consumed += (long long int)test(masks + block, count - block < 64 ? count - block : 64, grid);
+		}
+		operations += count;
+	} while (secondsSince(start) < minSeconds);
+	report(std::string("searchKernels::fitMasks/") + instructionSetName(instructions), operations, secondsSince(start));
+}
+
+void solverBenchmark::solve(const std::string &name, const boxDimensions &box, const std::vector<piece> &pieces,
+	cubeSolver::searchMode mode, bool findAll, bool breakSymmetry, int tableBits) {
+	cubeSolver cube(box);
+	cube.setSearchMode(mode)
+		.setEnumerateAll(findAll)
+		.setSymmetryBreaking(breakSymmetry)
+		.setTranspositionTable(tableBits > 0, tableBits)
+		.setVerbose(false);
+	for (int i = 0; i < (int)pieces.size(); ++i) {
+		cube.addPiece(pieces[i]);
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	cube.solve();
+	double seconds = secondsSince(start);
+
+	std::cout << "{\"benchmark\":\"" << name << "\",\"seconds\":" << seconds
+		<< ",\"solutions\":" << cube.noOfSolutions()
+		<< ",\"nodes\":" << cube.noOfIterations()
+		<< ",\"nodes_per_sec\":" << (double)cube.noOfIterations() / seconds
+		<< ",\"time_to_first_solution_s\":" << cube.timeToFirstSolution() << "}" << std::endl;
+}
+
+void solverBenchmark::solveDlx(const std::string &name, const boxDimensions &box, const std::vector<piece> &pieces) {
+	dlxSolver cube(box);
+	cube.setVerbose(false);
+	for (int i = 0; i < (int)pieces.size(); ++i) {
+		cube.addPiece(pieces[i]);
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	cube.solve();
+	double seconds = secondsSince(start);
+
+	std::cout << "{\"benchmark\":\"" << name << "\",\"seconds\":" << seconds
+		<< ",\"solutions\":" << (cube.isSolved() ? 1 : 0)
+		<< ",\"nodes\":" << cube.noOfIterations()
+		<< ",\"nodes_per_sec\":" << (double)cube.noOfIterations() / seconds
+		<< ",\"time_to_first_solution_s\":" << (cube.isSolved() ? seconds : -1) << "}" << std::endl;
+}
+
+void solverBenchmark::iterate(const std::string &name, const boxDimensions &box, const std::vector<piece> &pieces,
+	bool breakSymmetry, long long int budget) {
+	cubeSolver cube(box);
+	cube.setSymmetryBreaking(breakSymmetry)
+		.setVerbose(false);
+	for (int i = 0; i < (int)pieces.size(); ++i) {
+		cube.addPiece(pieces[i]);
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	solutionIterator solutions(cube);
+	long long int calls = 0;
+	double longestCall = 0;
+	while (!solutions.isExhausted()) {
+		std::chrono::steady_clock::time_point call = std::chrono::steady_clock::now();
+		solutions.advance(budget);
+		double callSeconds = secondsSince(call);
+		longestCall = callSeconds > longestCall ? callSeconds : longestCall;
+		++calls;
+	}
+	double seconds = secondsSince(start);
+
+	std::cout << "{\"benchmark\":\"" << name << "\",\"seconds\":" << seconds
+		<< ",\"solutions\":" << solutions.noOfSolutions()
+		<< ",\"nodes\":" << solutions.noOfIterations()
+		<< ",\"nodes_per_sec\":" << (double)solutions.noOfIterations() / seconds
+		<< ",\"calls\":" << calls
+		<< ",\"longest_call_s\":" << longestCall << "}" << std::endl;
+}
+
+void solverBenchmark::generate(const std::string &name, const boxDimensions &box, int pieceSize, int puzzles,
+	cubeSolver::searchMode mode) {
+	cubeSolver checker(box);
+	checker.setSearchMode(mode)
+		.setVerbose(false);
+	puzzleGenerator generator(checker, box, pieceSize);
+	puzzleDefinition puzzle;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < puzzles; ++i) {
+		generator.next(puzzle);
+	}
+	double seconds = secondsSince(start);
+
+	std::cout << "{\"benchmark\":\"" << name << "\",\"seconds\":" << seconds
+		<< ",\"candidates\":" << generator.noOfCandidates()
+		<< ",\"accepted\":" << generator.noOfAccepted()
+		<< ",\"puzzles_per_sec\":" << (double)generator.noOfAccepted() / seconds
+		<< ",\"candidates_per_sec\":" << (double)generator.noOfCandidates() / seconds << "}" << std::endl;
+}
+
+// Splits a box with a fixed seed so every build benchmarks the same puzzles
+static std::vector<piece> dissectBox(const boxDimensions &box, int pieceSize, unsigned int seed) {
+	return puzzleGenerator::dissect(box, pieceSize, seed);
+}
+
+// The M&S puzzle solved by main.cpp
+static std::vector<piece> mandsPuzzle() {
+	std::vector<piece> pieces;
+	pieces.push_back(piece(1));
+	pieces.back().addElement(element(0, 0, 0)).addElement(element(1, 0, 0)).addElement(element(0, 1, 0)).addElement(element(0, 1, 1));
+	pieces.push_back(piece(2));
+	pieces.back().addElement(element(0, 0, 0)).addElement(element(0, 0, 1)).addElement(element(0, 1, 0)).addElement(element(1, 1, 0));
+	pieces.push_back(piece(3));
+	pieces.back().addElement(element(0, 0, 0)).addElement(element(0, 1, 0)).addElement(element(1, 1, 0)).addElement(element(2, 1, 0));
+	pieces.push_back(piece(4));
+	pieces.back().addElement(element(0, 1, 0)).addElement(element(0, 0, 1)).addElement(element(1, 0, 1)).addElement(element(0, 1, 1)).addElement(element(0, 2, 1));
+	pieces.push_back(piece(5));
+	pieces.back().addElement(element(0, 0, 1)).addElement(element(1, 0, 1)).addElement(element(1, 0, 0)).addElement(element(1, 1, 0)).addElement(element(2, 1, 0));
+	pieces.push_back(piece(6));
+	pieces.back().addElement(element(0, 0, 0)).addElement(element(0, 1, 0)).addElement(element(0, 0, 1)).addElement(element(1, 0, 1)).addElement(element(2, 0, 1));
+	return pieces;
+}
+
+int main() {
+	std::vector<piece> mands = mandsPuzzle();
+
+	solverBenchmark::orientatePiece(mands[3]);
+	solverBenchmark::relocatePiece(mands[3]);
+	solverBenchmark::orientateElement();
+	solverBenchmark::constructPiece(mands[3]);
+	solverBenchmark::addAndRemovePiece(mands);
+	solverBenchmark::fitMasks(mands, scalarInstructions);
+	solverBenchmark::fitMasks(mands, sse2Instructions);
+	solverBenchmark::fitMasks(mands, avx2Instructions);
+
+	boxDimensions cube3(3, 3, 3);
+	solverBenchmark::solve("solve/mands/interleaved/first", cube3, mands, cubeSolver::interleavedSearch, false, false);
+	solverBenchmark::solve("solve/mands/interleaved/all", cube3, mands, cubeSolver::interleavedSearch, true, true);
+	solverBenchmark::solve("solve/mands/constrained/all", cube3, mands, cubeSolver::constrainedSearch, true, true);
+	solverBenchmark::solve("solve/mands/reference/first", cube3, mands, cubeSolver::referenceSearch, false, false);
+	solverBenchmark::solveDlx("solve/mands/dlx/first", cube3, mands);
+	solverBenchmark::generate("generate/333/unique", cube3, 5, 5, cubeSolver::interleavedSearch);
+
+	boxDimensions box334(3, 3, 4);
+	std::vector<piece> generated334 = dissectBox(box334, 5, 7u);
+	solverBenchmark::solve("solve/generated334/interleaved/all", box334, generated334, cubeSolver::interleavedSearch, true, true);
+	solverBenchmark::iterate("iterate/generated334/all/budget1000", box334, generated334, true, 1000);
+	solverBenchmark::solve("solve/generated334/interleaved/all/table", box334, generated334, cubeSolver::interleavedSearch, true, true, 20);
+	solverBenchmark::solve("solve/generated334/constrained/all", box334, generated334, cubeSolver::constrainedSearch, true, true);
+	solverBenchmark::solve("solve/generated334/constrained/all/table", box334, generated334, cubeSolver::constrainedSearch, true, true, 20);
+	solverBenchmark::solveDlx("solve/generated334/dlx/first", box334, generated334);
+
+	boxDimensions box444(4, 4, 4);
+	std::vector<piece> generated444 = dissectBox(box444, 6, 11u);
+	solverBenchmark::solve("solve/generated444/constrained/first", box444, generated444, cubeSolver::constrainedSearch, false, true);
+	solverBenchmark::solveDlx("solve/generated444/dlx/first", box444, generated444);
+
+	// Larger boxes need a build with a wide cellMask, see cellMask.h
+#if MAX_BOX_CELLS >= 125
+	boxDimensions box555(5, 5, 5);
+	std::vector<piece> generated555 = dissectBox(box555, 6, 3u);
+	solverBenchmark::solve("solve/generated555/constrained/first", box555, generated555, cubeSolver::constrainedSearch, false, true);
+	solverBenchmark::solveDlx("solve/generated555/dlx/first", box555, generated555);
+#endif
+#if MAX_BOX_CELLS >= 216
+	boxDimensions box666(6, 6, 6);
+	std::vector<piece> generated666 = dissectBox(box666, 4, 1u);
+	solverBenchmark::solve("solve/generated666/constrained/first", box666, generated666, cubeSolver::constrainedSearch, false, true);
+	solverBenchmark::solveDlx("solve/generated666/dlx/first", box666, generated666);
+#endif
+
+	return 0;
+}
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "boxDimensions.h"
+
+
+// Constructor taking in the size along the x, y and z axis,
+// by default the 3 x 3 x 3 cube of the original puzzle
+boxDimensions::boxDimensions(int x, int y, int z) {
+	// Positions are held by elements, see element.h. Checking each axis
+	// first also keeps the product below from overflowing.
+	if (x > 64 || y > 64 || z > 64) {
+		throw std::invalid_argument("Box must be at most 64 positions along each axis");
+	}
+	if (x < 1 || y < 1 || z < 1 || x * y * z > maxBoxCells) {
+		throw std::invalid_argument("Box must have between 1 and " + std::to_string(maxBoxCells)
+			+ " positions, build with a larger MAX_BOX_CELLS for bigger boxes");
+	}
+	sizes[0] = x;
+	sizes[1] = y;
+	sizes[2] = z;
+}
+
+// The number of positions along the dir axis
+int boxDimensions::get(int dir) const {
+	return sizes[dir];
+}
+
+// The total number of positions
+int boxDimensions::cells() const {
+	return sizes[0] * sizes[1] * sizes[2];
+}
+
+// True when all three sizes are equal
+bool boxDimensions::isCube() const {
+	return sizes[0] == sizes[1] && sizes[1] == sizes[2];
+}
+
+// Converts a position into its cell index
+int boxDimensions::cellIndex(int x, int y, int z) const {
+	return x + sizes[0] * (y + sizes[1] * z);
+}
+
+// Converts a cell index back into its position along the dir axis
+int boxDimensions::getPosition(int cell, int dir) const {
+	if (dir == 0) {
+		return cell % sizes[0];
+	}
+	else if (dir == 1) {
+		return (cell / sizes[0]) % sizes[1];
+	}
+	else {
+		return cell / (sizes[0] * sizes[1]);
+	}
+}
+
+// A mask holding every position of the box
+cellMask boxDimensions::allCells() const {
+	return firstCells(cells());
+}
+
+// A mask holding the positions at the given position along the dir axis
+cellMask boxDimensions::planeCells(int dir, int position) const {
+	cellMask plane = 0;
+	for (int cell = 0; cell < cells(); ++cell) {
+		if (getPosition(cell, dir) == position) {
+			plane |= cellBit(cell);
+		}
+	}
+	return plane;
+}
+
+
+std::ostream &operator<< (std::ostream &os, const boxDimensions &box) {
+	os << box.get(0) << " x " << box.get(1) << " x " << box.get(2);
+	return os;
+}
@@ -0,0 +1,239 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "dlxSolver.h"
+#include "placementTable.h"
+
+
+// Constructor taking in the size of the box, by default a 3 x 3 x 3 cube
+dlxSolver::dlxSolver(const boxDimensions &dimensions) : box(dimensions) {
+	symmetryBreaking = false;
+	anchorLevel = 0;
+	count = 0;
+	solved = false;
+	verbose = true;
+}
+
+// Inform the cube of a puzzle piece
+dlxSolver& dlxSolver::addPiece(const piece &toAdd) {
+	wrappedPieces.push_back(wrappedPiece(toAdd, box));
+	placedMasks.push_back(0);
+	return *this;
+}
+
+// Only search for solutions which are distinct under rotation of the
+// whole cube, see cubeSolver::setSymmetryBreaking(). Off by default.
+dlxSolver& dlxSolver::setSymmetryBreaking(bool enabled, int anchor) {
+	symmetryBreaking = enabled;
+	anchorLevel = anchor;
+	return *this;
+}
+
+// Print the matrix size and outcome to std::cout, on by default
+dlxSolver& dlxSolver::setVerbose(bool enabled) {
+	verbose = enabled;
+	return *this;
+}
+
+// Solve the puzzle. Call this after adding all puzzle pieces.
+void dlxSolver::solve() {
+	placements.build(wrappedPieces, box);
+	if (symmetryBreaking) {
+		if (anchorLevel < 0 || anchorLevel >= (int)wrappedPieces.size()) {
+			throw std::invalid_argument("The anchor piece must be one of the [" + std::to_string(wrappedPieces.size()) + "] pieces added");
+		}
+		placements.keepCanonicalPlacements(anchorLevel);
+	}
+
+	buildMatrix();
+	if (verbose) {
+		std::cout << "Exact cover matrix: [" << rowPiece.size() << "] rows, ["
+			<< (columnSize.size() - 1) << "] columns" << std::endl;
+	}
+
+	count = 0;
+	chosenRows.clear();
+	solved = search();
+	if (solved) {
+		for (int i = 0; i < (int)chosenRows.size(); ++i) {
+			placedMasks[rowPiece[chosenRows[i]]] = placements.getMask(rowPiece[chosenRows[i]], rowPlacement[chosenRows[i]]);
+		}
+	}
+
+	if (verbose) {
+		std::cout << (solved ? "Finished!!! Please print out cube." : "No solution exists.") << std::endl;
+		std::cout << "Rows tried: " << count << std::endl;
+	}
+}
+
+// True if the last solve() found a solution
+bool dlxSolver::isSolved() const {
+	return solved;
+}
+
+// The number of rows tried by the last solve()
+long long int dlxSolver::noOfIterations() const {
+	return count;
+}
+
+// Builds the linked matrix from the placement table
+void dlxSolver::buildMatrix() {
+	left.clear(); right.clear(); up.clear(); down.clear();
+	column.clear(); row.clear(); columnSize.clear();
+	rowPiece.clear(); rowPlacement.clear();
+
+	// The root
+	left.push_back(0); right.push_back(0); up.push_back(0); down.push_back(0);
+	column.push_back(0); row.push_back(-1); columnSize.push_back(0);
+
+	// Positions only have to be covered when the pieces fill the whole cube,
+	// otherwise some are left empty and their columns become secondary
+	int volume = 0;
+	for (int i = 0; i < (int)wrappedPieces.size(); ++i) {
+		volume += wrappedPieces[i].size();
+	}
+	bool exactFill = volume == box.cells();
+
+	for (int cell = 0; cell < box.cells(); ++cell) {
+		addColumn(exactFill);
+	}
+	for (int i = 0; i < (int)wrappedPieces.size(); ++i) {
+		addColumn(true);
+	}
+
+	for (int i = 0; i < (int)wrappedPieces.size(); ++i) {
+		for (int index = 0; index < placements.noOfPlacements(i); ++index) {
+			addRow(i, index);
+		}
+	}
+}
+
+// Adds a column header. Primary columns must be covered by every
+// solution and are linked into the root's list, others are not.
+void dlxSolver::addColumn(bool primary) {
+	int header = (int)left.size();
+	if (primary) {
+		left.push_back(left[0]);
+		right.push_back(0);
+		right[left[0]] = header;
+		left[0] = header;
+	}
+	else {
+		left.push_back(header);
+		right.push_back(header);
+	}
+	up.push_back(header);
+	down.push_back(header);
+	column.push_back(header);
+	row.push_back(-1);
+	columnSize.push_back(0);
+}
+
+// Appends one row for a placement of a piece
+void dlxSolver::addRow(int p, int index) {
+	int matrixRow = (int)rowPiece.size();
+	rowPiece.push_back(p);
+	rowPlacement.push_back(index);
+
+	// The piece column followed by one column per occupied position
+	std::vector<int> headers;
+	headers.push_back(1 + box.cells() + p);
+	for (cellMask remaining = placements.getMask(p, index); remaining != 0; remaining = withoutLowestCell(remaining)) {
+		headers.push_back(1 + lowestCell(remaining));
+	}
+
+	int first = (int)left.size();
+	for (int i = 0; i < (int)headers.size(); ++i) {
+		int node = (int)left.size();
+		int header = headers[i];
+
+		// Link into the bottom of the column
+		up.push_back(up[header]);
+		down.push_back(header);
+		down[up[header]] = node;
+		up[header] = node;
+		columnSize[header]++;
+
+		// Link into the end of the row
+		left.push_back(i == 0 ? node : node - 1);
+		right.push_back(first);
+		if (i > 0) {
+			right[node - 1] = node;
+			left[first] = node;
+		}
+
+		column.push_back(header);
+		row.push_back(matrixRow);
+	}
+}
+
+// Removes a column and every row intersecting it from the matrix
+void dlxSolver::cover(int header) {
+	right[left[header]] = right[header];
+	left[right[header]] = left[header];
+	for (int i = down[header]; i != header; i = down[i]) {
+		for (int j = right[i]; j != i; j = right[j]) {
+			down[up[j]] = down[j];
+			up[down[j]] = up[j];
+			columnSize[column[j]]--;
+		}
+	}
+}
+
+// Reverses cover()
+void dlxSolver::uncover(int header) {
+	for (int i = up[header]; i != header; i = up[i]) {
+		for (int j = left[i]; j != i; j = left[j]) {
+			columnSize[column[j]]++;
+			down[up[j]] = j;
+			up[down[j]] = j;
+		}
+	}
+	right[left[header]] = header;
+	left[right[header]] = header;
+}
+
+// Algorithm X, always branching on the column with the fewest rows.
+// Returns true once a solution has been found.
+bool dlxSolver::search() {
+	if (right[0] == 0) {
+		return true; // Every primary column is covered
+	}
+
+	int best = right[0];
+	for (int header = right[best]; header != 0; header = right[header]) {
+		if (columnSize[header] < columnSize[best]) {
+			best = header;
+		}
+	}
+	if (columnSize[best] == 0) {
+		return false; // Dead end, nothing can cover this column
+	}
+
+	cover(best);
+	for (int i = down[best]; i != best; i = down[i]) {
+		count++;
+		chosenRows.push_back(row[i]);
+		for (int j = right[i]; j != i; j = right[j]) {
+			cover(column[j]);
+		}
+
+		if (search()) {
+			return true;
+		}
+
+		for (int j = left[i]; j != i; j = left[j]) {
+			uncover(column[j]);
+		}
+		chosenRows.pop_back();
+	}
+	uncover(best);
+	return false;
+}
+
+
+std::ostream &operator<< (std::ostream &os, const dlxSolver &cube) {
+	placementTable::printGrid(os, cube.box, cube.placedMasks, cube.wrappedPieces);
+	return os;
+}
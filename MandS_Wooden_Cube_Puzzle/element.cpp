@@ -2,41 +2,18 @@
 #include "element.h"
 
 
-element::element(int xx, int yy, int zz) : x(xx), y(yy), z(zz) {};
-
-element::element(const element &toCopy) {
-	x = toCopy.x;
-	y = toCopy.y;
-	z = toCopy.z;
-}
-
-element& element::operator= (const element &toAssign) {
-	x = toAssign.x;
-	y = toAssign.y;
-	z = toAssign.z;
-	return *this;
-}
-
-int element::get(int dir) const {
-	if (dir == 0) {
-		return x;
-	}
-	else if (dir == 1) {
-		return y;
-	}
-	else {
-		return z;
-	}
+element::element() {
+	coords[0] = coords[1] = coords[2] = 0;
 }
 
-void element::update(int dir, int val) {
-	if (dir == 0) { x = val; }
-	if (dir == 1) { y = val; }
-	if (dir == 2) { z = val; }
+element::element(int xx, int yy, int zz) {
+	coords[0] = (signed char)xx;
+	coords[1] = (signed char)yy;
+	coords[2] = (signed char)zz;
 }
 
 
 std::ostream &operator<< (std::ostream &os, const element &e) {
-	os << "x: " << e.x << std::endl << "y: " << e.y << std::endl << "z: " << e.z;
+	os << "x: " << (int)e.coords[0] << std::endl << "y: " << (int)e.coords[1] << std::endl << "z: " << (int)e.coords[2];
 	return os;
 }
\ No newline at end of file
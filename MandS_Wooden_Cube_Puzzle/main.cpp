@@ -2,14 +2,29 @@
 
 Compile using g++:
 
-g++ -Wall -Wconversion -g -mtune=native -O3
+g++ -Wall -Wconversion -g -mtune=native -O3 -pthread
 -I" .\MandS_Wooden_Cube_Puzzle\MandS_Wooden_Cube_Puzzle\Header"
-main.cpp cubeSolver.cpp wrappedPiece.cpp piece.cpp element.cpp -o main.exe
+main.cpp cubeSolver.cpp wrappedPiece.cpp piece.cpp element.cpp placementTable.cpp dlxSolver.cpp workStealingPool.cpp solutionSink.cpp boxDimensions.cpp searchKernels.cpp puzzleLoader.cpp searchStats.cpp transpositionTable.cpp searchCheckpoint.cpp shardResult.cpp puzzleGenerator.cpp solutionIterator.cpp -o main.exe
 */
 
 #include <iostream>
+#include <fstream>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <stdexcept>
+#include <cstdlib> // atoi(), atof()
+#include <string>
+#include <vector>
 #include "piece.h"
 #include "cubeSolver.h"
+#include "dlxSolver.h"
+#include "solutionSink.h"
+#include "puzzleLoader.h"
+#include "puzzleGenerator.h"
+#include "solutionIterator.h"
+#include "shardResult.h"
+#include "placementTable.h"
 
 /*
 void testing() {
@@ -31,9 +46,334 @@ cout << "Rotate z: "<< outz << endl;
 cout << "End Testing" << endl;
 }*/
 
-int main() {
+// Solves every puzzle read from the stream back to back on one solver,
+// reporting the latency of each puzzle and the overall throughput
+int runBatch(std::istream &is, cubeSolver &cube) {
+	puzzleReader reader(is);
+	puzzleDefinition puzzle;
+	int puzzles = 0, solvedPuzzles = 0;
+	double totalSeconds = 0;
+
+	try {
+		while (reader.readPuzzle(puzzle)) {
+			cube.reset(puzzle.box);
+			for (int i = 0; i < (int)puzzle.pieces.size(); ++i) {
+				cube.addPiece(puzzle.pieces[i]);
+			}
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			cubeSolver::solveStatus status = cube.solve();
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			++puzzles;
+			totalSeconds += seconds;
+			if (cube.noOfSolutions() > 0) {
+				++solvedPuzzles;
+			}
+			std::cout << "Puzzle [" << puzzles << "] box [" << puzzle.box << "] pieces [" << puzzle.pieces.size()
+				<< "] solutions [" << cube.noOfSolutions() << "] status [" << cubeSolver::statusName(status)
+				<< "] latency [" << seconds * 1000 << "ms]" << std::endl;
+		}
+	}
+	catch (const std::exception &error) {
+		std::cout << error.what() << std::endl;
+		return 1;
+	}
+
+	std::cout << "Solved [" << solvedPuzzles << "] of [" << puzzles << "] puzzles in [" << totalSeconds << "s]";
+	if (totalSeconds > 0) {
+		std::cout << ", [" << puzzles / totalSeconds << "] puzzles per second";
+	}
+	std::cout << std::endl;
+	return 0;
+}
+
+// Set by Ctrl+C to cancel the search, which then stops and reports as usual
+static std::atomic<bool> interrupted(false);
+
+static void onInterrupt(int) {
+	interrupted.store(true);
+}
+
+// Generates puzzles whose solution is unique up to rotation, printing each
+// in the format read by --batch and the rate they are found at as comments
+int runGenerate(cubeSolver &cube, const boxDimensions &box, int pieceSize, unsigned int seed, int count) {
+	puzzleGenerator generator(cube, box, pieceSize, seed);
+	puzzleDefinition puzzle;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < count; ++i) {
+		if (!generator.next(puzzle)) {
+			std::cout << "# No unique puzzle found, giving up" << std::endl;
+			break;
+		}
+		std::cout << "# Puzzle [" << (i + 1) << "] after [" << generator.noOfCandidates() << "] candidates" << std::endl;
+		std::cout << puzzle << std::endl;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "# Accepted [" << generator.noOfAccepted() << "] of [" << generator.noOfCandidates() << "] candidates in [" << seconds << "s]";
+	if (seconds > 0) {
+		std::cout << ", [" << (double)generator.noOfAccepted() / seconds << "] puzzles per second, ["
+			<< (double)generator.noOfCandidates() / seconds << "] candidates per second";
+	}
+	std::cout << std::endl;
+	return 0;
+}
+
+// Combines the result files of the shards of one search, printing the
+// totals and, if asked, every solution kept
+int runMerge(const std::vector<std::string> &files, bool printAll) {
+	shardResult merged;
+	std::vector<char> seen;
+	try {
+		for (int i = 0; i < (int)files.size(); ++i) {
+			shardResult shard;
+			shard.load(files[i]);
+			if (i == 0) {
+				merged = shard;
+				seen.assign(shard.count, 0);
+			}
+			else {
+				merged.merge(shard);
+			}
+			if (seen[shard.index]) {
+				throw std::runtime_error("Shard [" + std::to_string(shard.index) + "] was given twice");
+			}
+			seen[shard.index] = 1;
+		}
+	}
+	catch (const std::exception &error) {
+		std::cout << error.what() << std::endl;
+		return 1;
+	}
+	if (files.empty()) {
+		std::cout << "No shard results to merge" << std::endl;
+		return 1;
+	}
+
+	int found = 0;
+	std::cout << "Missing shards:";
+	for (int index = 0; index < merged.count; ++index) {
+		if (seen[index]) {
+			++found;
+		}
+		else {
+			std::cout << " [" << index << "]";
+		}
+	}
+	std::cout << (found == merged.count ? " none" : "") << std::endl;
+	std::cout << "Merged [" << found << "] of [" << merged.count << "] shards of a [" << merged.box << "] box" << std::endl;
+
+	if (printAll) {
+		for (int i = 0; i < (int)merged.kept.size(); ++i) {
+			std::cout << "Solution [" << (i + 1) << "]" << std::endl;
+			placementTable::printGrid(std::cout, merged.box, merged.kept[i], merged.ids);
+			std::cout << std::endl;
+		}
+	}
+	merged.stats.printDepths(std::cout);
+	std::cout << "Solutions found: [" << merged.solutions << "]" << std::endl;
+	std::cout << "Longest shard: [" << merged.elapsedSeconds << "s], all shards: [" << merged.totalSeconds << "s]" << std::endl;
+	if (merged.firstSolutionSeconds >= 0) {
+		std::cout << "Time to first solution: [" << merged.firstSolutionSeconds << "s]" << std::endl;
+	}
+	return found == merged.count ? 0 : 1;
+}
+
+int main(int argc, char *argv[]) {
 	// testing();
 
+	// Pass --reference to use the original orientate-everything-first search,
+	// --constrained to fill the most constrained position first,
+	// --dlx to use the Dancing Links exact cover solver instead of cubeSolver
+	// and --break-symmetry to skip rotated copies of the solution.
+	// --no-region-pruning keeps searching when the empty space splits into
+	// regions no combination of the remaining pieces can fill.
+	// --no-colour-pruning likewise when the remaining pieces can no longer
+	// cover the marked positions of a colouring, e.g. a checkerboard.
+	// --table BITS remembers dead-end states in a table of 2^BITS slots,
+	// replacing the shallowest unless --table-replace-always is given.
+	// --threads N [--split-depth D] solves on N threads.
+	// --deadline S gives up after S seconds and --node-limit N after
+	// visiting N nodes, as does Ctrl+C, printing the statistics so far.
+	// With --batch or --generate they limit each puzzle.
+	// --checkpoint FILE saves the search to FILE every 60 seconds, or every
+	// S seconds with --checkpoint-interval S, and --resume carries on from it.
+	// --shard I/N searches only shard I (0 to N - 1) of N, writing what it
+	// found to shard_I_of_N.txt or to --shard-file FILE. The solutions
+	// --print would print are kept in the file instead.
+	// --merge FILE... combines shard files, printing the solutions with --print.
+	// --all counts every solution, adding --print prints each one as found.
+	// --first K instead prints the first K solutions one at a time, with the
+	// placement each piece uses, taking them from a solutionIterator.
+	// --box X Y Z packs the pieces into an X x Y x Z box instead of the cube,
+	// boxes of over 64 positions need main_wide.exe (see cellMask.h).
+	// --batch FILE solves every puzzle in FILE (- for standard input) without
+	// waiting for input at the end, see puzzleLoader.h for the format.
+	// --generate N prints N new puzzles for the box, each splitting it into
+	// pieces of --piece-size K positions (5 by default) which fit together
+	// in only one way up to rotation. --seed S varies the puzzles.
+	cubeSolver::searchMode mode = cubeSolver::interleavedSearch;
+	bool useDlx = false, breakSymmetry = false, findAll = false, printAll = false, regionPruning = true, colourPruning = true;
+	int threads = 1, splitDepth = 2, tableBits = 0;
+	transpositionTable::replacementPolicy tablePolicy = transpositionTable::replaceShallower;
+	int sizeX = 3, sizeY = 3, sizeZ = 3;
+	std::string batchFile, checkpointFile, shardFile;
+	int shardIndex = 0, shardCount = 1;
+	bool merging = false;
+	int generateCount = 0, pieceSize = 5, firstCount = 0;
+	unsigned int seed = 1;
+	std::vector<std::string> mergeFiles;
+	double checkpointSeconds = 60, deadline = 0;
+	long long int nodeLimit = 0;
+	bool resume = false;
+	for (int i = 1; i < argc; ++i) {
+		if (std::string(argv[i]) == "--reference") {
+			mode = cubeSolver::referenceSearch;
+		}
+		else if (std::string(argv[i]) == "--constrained") {
+			mode = cubeSolver::constrainedSearch;
+		}
+		else if (std::string(argv[i]) == "--dlx") {
+			useDlx = true;
+		}
+		else if (std::string(argv[i]) == "--break-symmetry") {
+			breakSymmetry = true;
+		}
+		else if (std::string(argv[i]) == "--no-region-pruning") {
+			regionPruning = false;
+		}
+		else if (std::string(argv[i]) == "--no-colour-pruning") {
+			colourPruning = false;
+		}
+		else if (std::string(argv[i]) == "--all") {
+			findAll = true;
+		}
+		else if (std::string(argv[i]) == "--print") {
+			printAll = true;
+		}
+		else if (std::string(argv[i]) == "--first" && i + 1 < argc) {
+			firstCount = std::atoi(argv[++i]);
+		}
+		else if (std::string(argv[i]) == "--box" && i + 3 < argc) {
+			sizeX = std::atoi(argv[++i]);
+			sizeY = std::atoi(argv[++i]);
+			sizeZ = std::atoi(argv[++i]);
+			// Checked here so that every use of the box below can rely on it
+			try {
+				boxDimensions(sizeX, sizeY, sizeZ);
+			}
+			catch (const std::invalid_argument &error) {
+				std::cout << error.what() << std::endl;
+				return 1;
+			}
+		}
+		else if (std::string(argv[i]) == "--batch" && i + 1 < argc) {
+			batchFile = argv[++i];
+		}
+		else if (std::string(argv[i]) == "--generate" && i + 1 < argc) {
+			generateCount = std::atoi(argv[++i]);
+		}
+		else if (std::string(argv[i]) == "--piece-size" && i + 1 < argc) {
+			pieceSize = std::atoi(argv[++i]);
+			if (pieceSize < 1 || pieceSize > piece::maxElements) {
+				std::cout << "Expected --piece-size K with K from 1 to " << piece::maxElements << std::endl;
+				return 1;
+			}
+		}
+		else if (std::string(argv[i]) == "--seed" && i + 1 < argc) {
+			seed = (unsigned int)std::atol(argv[++i]);
+		}
+		else if (std::string(argv[i]) == "--table" && i + 1 < argc) {
+			tableBits = std::atoi(argv[++i]);
+		}
+		else if (std::string(argv[i]) == "--table-replace-always") {
+			tablePolicy = transpositionTable::replaceAlways;
+		}
+		else if (std::string(argv[i]) == "--threads" && i + 1 < argc) {
+			threads = std::atoi(argv[++i]);
+		}
+		else if (std::string(argv[i]) == "--split-depth" && i + 1 < argc) {
+			splitDepth = std::atoi(argv[++i]);
+		}
+		else if (std::string(argv[i]) == "--checkpoint" && i + 1 < argc) {
+			checkpointFile = argv[++i];
+		}
+		else if (std::string(argv[i]) == "--checkpoint-interval" && i + 1 < argc) {
+			checkpointSeconds = std::atof(argv[++i]);
+		}
+		else if (std::string(argv[i]) == "--deadline" && i + 1 < argc) {
+			deadline = std::atof(argv[++i]);
+		}
+		else if (std::string(argv[i]) == "--node-limit" && i + 1 < argc) {
+			nodeLimit = std::atoll(argv[++i]);
+		}
+		else if (std::string(argv[i]) == "--resume") {
+			resume = true;
+		}
+		else if (std::string(argv[i]) == "--shard" && i + 1 < argc) {
+			std::string shard = argv[++i];
+			std::string::size_type slash = shard.find('/');
+			shardIndex = std::atoi(shard.substr(0, slash).c_str());
+			shardCount = slash == std::string::npos ? 1 : std::atoi(shard.substr(slash + 1).c_str());
+			if (shardCount < 1 || shardIndex < 0 || shardIndex >= shardCount) {
+				std::cout << "Expected --shard I/N with I from 0 to N - 1" << std::endl;
+				return 1;
+			}
+		}
+		else if (std::string(argv[i]) == "--shard-file" && i + 1 < argc) {
+			shardFile = argv[++i];
+		}
+		else if (std::string(argv[i]) == "--merge") {
+			merging = true;
+		}
+		else if (merging && argv[i][0] != '-') {
+			mergeFiles.push_back(argv[i]);
+		}
+	}
+
+	if (merging) {
+		return runMerge(mergeFiles, printAll);
+	}
+
+	if (generateCount > 0) {
+		boxDimensions box(sizeX, sizeY, sizeZ);
+		cubeSolver cube(box);
+		cube.setSearchMode(mode)
+			.setRegionPruning(regionPruning)
+			.setColourPruning(colourPruning)
+			.setTranspositionTable(tableBits > 0, tableBits, tablePolicy)
+			.setDeadline(deadline)
+			.setNodeLimit(nodeLimit)
+			.setVerbose(false);
+		return runGenerate(cube, box, pieceSize, seed, generateCount);
+	}
+
+	if (!batchFile.empty()) {
+		cubeSolver cube;
+		cube.setSearchMode(mode)
+			.setSymmetryBreaking(breakSymmetry)
+			.setRegionPruning(regionPruning)
+			.setColourPruning(colourPruning)
+			.setTranspositionTable(tableBits > 0, tableBits, tablePolicy)
+			.setThreads(threads, splitDepth)
+			.setEnumerateAll(findAll)
+			.setDeadline(deadline)
+			.setNodeLimit(nodeLimit)
+			.setVerbose(false);
+
+		if (batchFile == "-") {
+			return runBatch(std::cin, cube);
+		}
+		std::ifstream file(batchFile.c_str());
+		if (!file) {
+			std::cout << "Cannot open [" << batchFile << "]" << std::endl;
+			return 1;
+		}
+		return runBatch(file, cube);
+	}
+
 	piece piece1(1);
 	piece1.addElement(element(0, 0, 0))
 		.addElement(element(1, 0, 0))
@@ -79,16 +419,116 @@ int main() {
 		.addElement(element(2, 0, 1));
 	std::cout << piece6 << std::endl;
 
-	cubeSolver cube;
-	cube.addPiece(piece1)
-		.addPiece(piece2)
-		.addPiece(piece3)
-		.addPiece(piece4)
-		.addPiece(piece5)
-		.addPiece(piece6);
+	std::vector<piece> pieces;
+	pieces.push_back(piece1);
+	pieces.push_back(piece2);
+	pieces.push_back(piece3);
+	pieces.push_back(piece4);
+	pieces.push_back(piece5);
+	pieces.push_back(piece6);
+
+	if (useDlx) {
+		dlxSolver cube(boxDimensions(sizeX, sizeY, sizeZ));
+		cube.setSymmetryBreaking(breakSymmetry);
+		for (int i = 0; i < (int)pieces.size(); ++i) {
+			cube.addPiece(pieces[i]);
+		}
+
+		cube.solve();
+		std::cout << cube;
+	}
+	else {
+		// Shards keep their solutions for the merge rather than printing them
+		streamSink printer(std::cout);
+		collectingSink collector;
+		solutionSink *sink = !printAll ? 0 : (shardCount > 1 ? (solutionSink *)&collector : &printer);
+
+		cubeSolver cube(boxDimensions(sizeX, sizeY, sizeZ));
+		cube.setSearchMode(mode)
+			.setSymmetryBreaking(breakSymmetry)
+			.setRegionPruning(regionPruning)
+			.setColourPruning(colourPruning)
+			.setTranspositionTable(tableBits > 0, tableBits, tablePolicy)
+			.setThreads(threads, splitDepth)
+			.setShard(shardIndex, shardCount)
+			.setEnumerateAll(findAll, sink)
+			.setCheckpoint(checkpointFile, checkpointSeconds)
+			.setResume(resume)
+			.setDeadline(deadline)
+			.setNodeLimit(nodeLimit)
+			.setCancelToken(&interrupted);
+		std::signal(SIGINT, onInterrupt);
+		for (int i = 0; i < (int)pieces.size(); ++i) {
+			cube.addPiece(pieces[i]);
+		}
+
+		if (firstCount > 0) {
+			solutionIterator solutions(cube);
+			for (int n = 0; n < firstCount && solutions.advance(); ++n) {
+				std::cout << "Solution [" << (n + 1) << "] placements:";
+				for (int i = 0; i < (int)pieces.size(); ++i) {
+					std::cout << " [" << solutions.getPlacementIndices()[i] << "]";
+				}
+				std::cout << std::endl << solutions << std::endl;
+			}
+			std::cout << "Solutions taken: [" << solutions.noOfSolutions() << "] after [" << solutions.noOfIterations()
+				<< "] nodes" << (solutions.isExhausted() ? ", no more exist" : "") << std::endl;
+		}
+		else {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			cubeSolver::solveStatus status;
+			try {
+				status = cube.solve();
+			}
+			catch (const std::exception &error) {
+				std::cout << error.what() << std::endl;
+				return 1;
+			}
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if (!findAll) {
+				std::cout << cube;
+			}
+
+			// Merging part of a shard would undercount the search
+			if (shardCount > 1 && status != cubeSolver::solvedStatus && status != cubeSolver::exhaustedStatus) {
+				std::cout << "Shard [" << shardIndex << "] stopped early ([" << cubeSolver::statusName(status)
+					<< "]), not writing [" << shardFile << "]" << std::endl;
+				return 1;
+			}
+			if (shardCount > 1) {
+				shardResult result;
+				result.index = shardIndex;
+				result.count = shardCount;
+				result.fingerprint = cube.fingerprint();
+				result.box = boxDimensions(sizeX, sizeY, sizeZ);
+				for (int i = 0; i < (int)pieces.size(); ++i) {
+					result.ids.push_back(pieces[i].getId());
+				}
+				result.solutions = cube.noOfSolutions();
+				result.elapsedSeconds = seconds;
+				result.totalSeconds = seconds;
+				result.firstSolutionSeconds = cube.timeToFirstSolution();
+				result.sharedDepths = cube.noOfSharedDepths();
+				result.stats = cube.getStats();
+				if (findAll) {
+					result.kept = collector.getSolutions();
+				}
+				else if (cube.isSolved()) {
+					result.kept.push_back(cube.getPlacedMasks());
+				}
 
-	cube.solve();
-	std::cout << cube;
+				if (shardFile.empty()) {
+					shardFile = "shard_" + std::to_string(shardIndex) + "_of_" + std::to_string(shardCount) + ".txt";
+				}
+				if (!result.save(shardFile)) {
+					std::cout << "Cannot write [" << shardFile << "]" << std::endl;
+					return 1;
+				}
+				std::cout << "Wrote shard [" << shardIndex << "] of [" << shardCount << "] to [" << shardFile << "]" << std::endl;
+				return 0;
+			}
+		}
+	}
 
 	std::cout << "\nFinished - Please type something to quit" << std::endl;
 	int dummy; std::cin >> dummy;
@@ -1,20 +1,12 @@
 #include <iostream>
-#include <vector>
+#include <stdexcept>
+#include <type_traits>
 #include "piece.h"
 
 
-piece::piece(int identifier) : id(identifier) {}
+static_assert(std::is_trivially_copyable<piece>::value, "piece must copy as plain memory");
 
-piece::piece(const piece &toCopy) {
-	id = toCopy.getId();
-	elements = toCopy.elements;
-}
-
-piece& piece::operator= (const piece &toAssign) {
-	id = toAssign.getId();
-	elements = toAssign.elements;
-	return *this;
-}
+piece::piece(int identifier) : id(identifier), noOfElements(0) {}
 
 int piece::getId() const {
 	return id;
@@ -22,33 +14,25 @@ int piece::getId() const {
 
 // Add elements to this piece after construction.
 // All pieces are constructed "empty" by the base constructor.
+// Throws std::length_error beyond maxElements.
 piece& piece::addElement(const element &toAdd) {
-	elements.push_back(toAdd);
+	if (noOfElements == maxElements) {
+		throw std::length_error("A piece may have at most 16 elements");
+	}
+	elements[noOfElements++] = toAdd;
 	return *this;
 }
 
-element piece::getElement(int i) const {
-	return elements[i];
-}
-
-element& piece::updateElement(int i) {
-	return elements[i];
-}
-
 // Shifts the piece along the x, y or z axis
 piece& piece::shift(int dir, int adjustment) {
 	if (adjustment != 0) {
-		for (int k = 0; k < size(); ++k) {
-			elements[k].update(dir, getElement(k).get(dir) + adjustment);
+		for (int k = 0; k < noOfElements; ++k) {
+			elements[k].update(dir, elements[k].get(dir) + adjustment);
 		}
 	}
 	return *this;
 }
 
-int piece::size() const {
-	return (int)elements.size();
-}
-
 
 std::ostream &operator<< (std::ostream &os, const piece &p) {
 	os << "Piece: " << p.id << std::endl;
@@ -0,0 +1,204 @@
+#include <vector>
+#include "placementTable.h"
+#include "wrappedPiece.h"
+#include "piece.h"
+
+
+placementTable::placementTable() {}
+
+// Enumerates all placements of all pieces within the box. Each wrappedPiece
+// is left orientated and located at its final placement afterwards.
+void placementTable::build(std::vector<wrappedPiece> &wrappedPieces, const boxDimensions &dimensions) {
+	box = dimensions;
+	// Clear rather than replace each piece's vectors so that their memory
+	// is reused when one table is built for puzzle after puzzle
+	int pieces = (int)wrappedPieces.size();
+	masks.resize(pieces);
+	orientations.resize(pieces);
+	locations.resize(pieces);
+	orientationStart.resize(pieces);
+	for (int p = 0; p < pieces; ++p) {
+		masks[p].clear();
+		orientations[p].clear();
+		locations[p].clear();
+		orientationStart[p].clear();
+	}
+
+	for (int p = 0; p < pieces; ++p) {
+		for (int i = 0; i < wrappedPieces[p].noOfOrientations(); ++i) {
+			int orientation = wrappedPieces[p].getOrientation(i);
+			orientationStart[p].push_back((int)masks[p].size());
+			wrappedPieces[p].orientatePiece(orientation);
+
+			for (int location = 0; location < wrappedPieces[p].noOfLocations(); ++location) {
+				const piece &located = wrappedPieces[p].relocatePiece(location);
+
+				cellMask mask = 0;
+				for (int e = 0; e < located.size(); ++e) {
+					element elem = located.getElement(e);
+					mask |= cellBit(box.cellIndex(elem.get(0), elem.get(1), elem.get(2)));
+				}
+
+				masks[p].push_back(mask);
+				orientations[p].push_back(orientation);
+				locations[p].push_back(location);
+			}
+		}
+		orientationStart[p].push_back((int)masks[p].size());
+	}
+}
+
+const boxDimensions &placementTable::getBox() const {
+	return box;
+}
+
+int placementTable::noOfPieces() const {
+	return (int)masks.size();
+}
+
+int placementTable::noOfPlacements(int p) const {
+	return (int)masks[p].size();
+}
+
+// Index range [firstPlacement, lastPlacement) of a piece's i-th distinct orientation
+int placementTable::firstPlacement(int p, int orientation) const {
+	return orientationStart[p][orientation];
+}
+
+int placementTable::lastPlacement(int p, int orientation) const {
+	return orientationStart[p][orientation + 1];
+}
+
+// Rotating the whole box maps every solution onto another solution, so
+// 24 rotated copies of each exist in a cube (fewer in other boxes, only
+// rotations mapping the box onto itself count). Keeping only the
+// placements of one (anchor) piece which are the smallest mask among all
+// rotations of that mask leaves a single representative of each group
+// of solutions.
+void placementTable::keepCanonicalPlacements(int p) {
+	std::vector<int> symmetries;
+	for (int orientation = 1; orientation < 24; ++orientation) {
+		if (preservesBox(orientation)) {
+			symmetries.push_back(orientation);
+		}
+	}
+
+	std::vector<cellMask> keptMasks;
+	std::vector<int> keptOrientations, keptLocations, keptStart;
+
+	for (int i = 0; i + 1 < (int)orientationStart[p].size(); ++i) {
+		keptStart.push_back((int)keptMasks.size());
+
+		for (int index = orientationStart[p][i]; index < orientationStart[p][i + 1]; ++index) {
+			bool canonical = true;
+			for (int s = 0; s < (int)symmetries.size() && canonical; ++s) {
+				canonical = rotateMask(masks[p][index], symmetries[s]) >= masks[p][index];
+			}
+
+			if (canonical) {
+				keptMasks.push_back(masks[p][index]);
+				keptOrientations.push_back(orientations[p][index]);
+				keptLocations.push_back(locations[p][index]);
+			}
+		}
+	}
+	keptStart.push_back((int)keptMasks.size());
+
+	masks[p] = keptMasks;
+	orientations[p] = keptOrientations;
+	locations[p] = keptLocations;
+	orientationStart[p] = keptStart;
+}
+
+// The masks of every placement of a piece, stored contiguously
+const cellMask *placementTable::getMasks(int p) const {
+	return masks[p].data();
+}
+
+cellMask placementTable::getMask(int p, int index) const {
+	return masks[p][index];
+}
+
+int placementTable::getOrientation(int p, int index) const {
+	return orientations[p][index];
+}
+
+int placementTable::getLocation(int p, int index) const {
+	return locations[p][index];
+}
+
+// True if the rotations of an orientation (0 to 23) map the box onto itself
+bool placementTable::preservesBox(int orientation) const {
+	element turned = wrappedPiece::orientateElement(orientation, element(box.get(0), box.get(1), box.get(2)));
+	for (int dir = 0; dir < 3; ++dir) {
+		if (turned.get(dir) != box.get(dir) && turned.get(dir) != -box.get(dir)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Rotates a mask about the centre of the box using the rotations of an
+// orientation (0 to 23). The orientation must preserve the box.
+cellMask placementTable::rotateMask(cellMask mask, int orientation) const {
+	cellMask rotated = 0;
+	for (cellMask remaining = mask; remaining != 0; remaining = withoutLowestCell(remaining)) {
+		int cell = lowestCell(remaining);
+
+		// Doubling the coordinates puts the centre of the box on the
+		// origin whilst keeping them integers, for odd and even sizes alike
+		element centred(2 * box.getPosition(cell, 0) - (box.get(0) - 1),
+			2 * box.getPosition(cell, 1) - (box.get(1) - 1),
+			2 * box.getPosition(cell, 2) - (box.get(2) - 1));
+		element turned = wrappedPiece::orientateElement(orientation, centred);
+
+		rotated |= cellBit(box.cellIndex((turned.get(0) + (box.get(0) - 1)) / 2,
+			(turned.get(1) + (box.get(1) - 1)) / 2,
+			(turned.get(2) + (box.get(2) - 1)) / 2));
+	}
+	return rotated;
+}
+
+// Rebuilds the id of the piece occupying each box position from the
+// mask and id of each piece, indexed [z][y][x]
+std::vector<std::vector<std::vector<int> > > placementTable::buildIdGrid(const boxDimensions &box,
+	const std::vector<cellMask> &placedMasks, const std::vector<int> &ids) {
+	std::vector<int> row(box.get(0));
+	std::vector<std::vector<int> > mat(box.get(1), row);
+	std::vector<std::vector<std::vector<int> > > idGrid(box.get(2), mat);
+
+	for (int i = 0; i < (int)placedMasks.size(); ++i) {
+		for (cellMask remaining = placedMasks[i]; remaining != 0; remaining = withoutLowestCell(remaining)) {
+			int cell = lowestCell(remaining);
+			idGrid[box.getPosition(cell, 2)][box.getPosition(cell, 1)][box.getPosition(cell, 0)] = ids[i];
+		}
+	}
+	return idGrid;
+}
+
+// Prints the box given the mask each piece occupies
+void placementTable::printGrid(std::ostream &os, const boxDimensions &box,
+	const std::vector<cellMask> &placedMasks, const std::vector<wrappedPiece> &wrappedPieces) {
+	std::vector<int> ids;
+	for (int i = 0; i < (int)wrappedPieces.size(); ++i) {
+		ids.push_back(wrappedPieces[i].getId());
+	}
+	printGrid(os, box, placedMasks, ids);
+}
+
+// Prints the box given the mask and id of each piece
+void placementTable::printGrid(std::ostream &os, const boxDimensions &box,
+	const std::vector<cellMask> &placedMasks, const std::vector<int> &ids) {
+	std::vector<std::vector<std::vector<int> > > idGrid = buildIdGrid(box, placedMasks, ids);
+
+	os << "Cube:" << std::endl;
+	for (int y = 0; y < box.get(1); ++y) {
+		for (int z = 0; z < box.get(2); ++z) {
+			for (int x = 0; x < box.get(0); ++x) {
+				os << idGrid[z][y][x] << " ";
+			}
+			os << " ";
+		}
+		os << std::endl;
+	}
+}
\ No newline at end of file
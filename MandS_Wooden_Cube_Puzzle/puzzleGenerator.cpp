@@ -0,0 +1,99 @@
+#include <vector>
+#include "puzzleGenerator.h"
+
+
+// Constructor taking in the solver to check candidates with, which is set
+// to check uniqueness, the box, the size of its pieces (1 to
+// piece::maxElements) and the seed
+puzzleGenerator::puzzleGenerator(cubeSolver &solver, const boxDimensions &dimensions, int size, unsigned int seed)
+	: checker(solver), box(dimensions), pieceSize(size < 1 ? 1 : size > piece::maxElements ? piece::maxElements : size), state(seed), candidates(0), accepted(0) {
+	checker.setUniquenessCheck(true);
+}
+
+// Generates candidates until one has a unique solution and returns it,
+// or gives up after maxCandidates returning false
+bool puzzleGenerator::next(puzzleDefinition &puzzle, long long int maxCandidates) {
+	for (long long int tried = 0; tried < maxCandidates; ++tried) {
+		std::vector<piece> pieces = dissect(box, pieceSize, state);
+		++candidates;
+		if (isUnique(pieces)) {
+			++accepted;
+			puzzle.box = box;
+			puzzle.pieces = pieces;
+			return true;
+		}
+	}
+	return false;
+}
+
+// True if the pieces fill the box in exactly one way up to rotation
+bool puzzleGenerator::isUnique(const std::vector<piece> &pieces) {
+	checker.reset(box);
+	for (int i = 0; i < (int)pieces.size(); ++i) {
+		checker.addPiece(pieces[i]);
+	}
+	// A search stopped early by a limit of the solver proves nothing
+	return checker.solve() == cubeSolver::solvedStatus && checker.noOfDistinctSolutions() == 1;
+}
+
+// The number of candidates generated so far
+long long int puzzleGenerator::noOfCandidates() const {
+	return candidates;
+}
+
+// The number of candidates kept so far
+long long int puzzleGenerator::noOfAccepted() const {
+	return accepted;
+}
+
+// Splits a box into pieces of roughly pieceSize positions by growing
+// each piece from the lowest empty position into random empty
+// neighbours, drawing from and advancing the given generator state
+std::vector<piece> puzzleGenerator::dissect(const boxDimensions &box, int pieceSize, unsigned int &state) {
+	std::vector<int> owner(box.cells(), 0);
+	std::vector<piece> pieces;
+
+	for (int start = 0; start < box.cells(); ++start) {
+		if (owner[start] != 0) {
+			continue;
+		}
+
+		int id = (int)pieces.size() + 1;
+		std::vector<int> cells(1, start);
+		owner[start] = id;
+		while ((int)cells.size() < pieceSize) {
+			// Collect the empty neighbours of the piece grown so far
+			std::vector<int> frontier;
+			for (int i = 0; i < (int)cells.size(); ++i) {
+				for (int dir = 0; dir < 3; ++dir) {
+					for (int step = -1; step <= 1; step += 2) {
+						int position[3] = { box.getPosition(cells[i], 0), box.getPosition(cells[i], 1), box.getPosition(cells[i], 2) };
+						position[dir] += step;
+						if (position[dir] < 0 || position[dir] >= box.get(dir)) {
+							continue;
+						}
+						int next = box.cellIndex(position[0], position[1], position[2]);
+						if (owner[next] == 0) {
+							frontier.push_back(next);
+						}
+					}
+				}
+			}
+			if (frontier.empty()) {
+				break;
+			}
+
+			state = state * 1103515245u + 12345u;
+			int next = frontier[(state >> 16) % frontier.size()];
+			owner[next] = id;
+			cells.push_back(next);
+		}
+
+		piece grown(id);
+		for (int i = 0; i < (int)cells.size(); ++i) {
+			grown.addElement(element(box.getPosition(cells[i], 0), box.getPosition(cells[i], 1), box.getPosition(cells[i], 2)));
+		}
+		pieces.push_back(grown);
+	}
+	return pieces;
+}
\ No newline at end of file
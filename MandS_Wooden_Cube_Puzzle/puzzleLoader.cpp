@@ -0,0 +1,152 @@
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "puzzleLoader.h"
+
+
+puzzleReader::puzzleReader(std::istream &in) : is(in), lineNumber(0), hasPending(false) {}
+
+// Reads the next puzzle, returning false once the stream holds no more
+bool puzzleReader::readPuzzle(puzzleDefinition &puzzle) {
+	puzzle.box = boxDimensions();
+	puzzle.pieces.clear();
+
+	bool started = false;
+	int firstLine = 0;
+	std::string line;
+	while (nextLine(line)) {
+		std::istringstream fields(line);
+		std::string keyword;
+		fields >> keyword;
+
+		if (keyword == "Box:") {
+			if (started) {
+				// The start of the next puzzle
+				pendingLine = line;
+				hasPending = true;
+				break;
+			}
+
+			firstLine = lineNumber;
+			int x, y, z;
+			if (!(fields >> x >> y >> z)) {
+				fail("expected \"Box: x y z\"");
+			}
+			try {
+				puzzle.box = boxDimensions(x, y, z);
+			}
+			catch (const std::invalid_argument &error) {
+				fail(error.what());
+			}
+			started = true;
+		}
+		else if (keyword == "Piece:") {
+			int id;
+			if (!(fields >> id) || id <= 0) {
+				fail("expected \"Piece: id\" with a positive id");
+			}
+
+			std::vector<int> x = readAxis("x:");
+			std::vector<int> y = readAxis("y:");
+			std::vector<int> z = readAxis("z:");
+			if (x.empty() || x.size() != y.size() || x.size() != z.size()) {
+				fail("x, y and z rows must hold the same, non-zero, number of values");
+			}
+			if ((int)x.size() > piece::maxElements) {
+				fail("a piece may have at most " + std::to_string(piece::maxElements) + " elements");
+			}
+
+			piece toAdd(id);
+			for (int i = 0; i < (int)x.size(); ++i) {
+				// A repeat would count towards the piece's size without
+				// occupying another position
+				for (int j = 0; j < i; ++j) {
+					if (x[j] == x[i] && y[j] == y[i] && z[j] == z[i]) {
+						fail("element " + std::to_string(i + 1) + " repeats element " + std::to_string(j + 1));
+					}
+				}
+				toAdd.addElement(element(x[i], y[i], z[i]));
+			}
+			puzzle.pieces.push_back(toAdd);
+			started = true;
+		}
+		else if (keyword == "End") {
+			break;
+		}
+		else {
+			fail("expected \"Box:\", \"Piece:\" or \"End\"");
+		}
+	}
+
+	// The solvers need at least one piece to place
+	if (started && puzzle.pieces.empty()) {
+		fail("a puzzle must have at least one piece", firstLine);
+	}
+	return started;
+}
+
+// Reads the next line which is neither blank nor a comment
+bool puzzleReader::nextLine(std::string &line) {
+	if (hasPending) {
+		line = pendingLine;
+		hasPending = false;
+		return true;
+	}
+
+	while (std::getline(is, line)) {
+		++lineNumber;
+		std::string::size_type start = line.find_first_not_of(" \t\r");
+		if (start != std::string::npos && line[start] != '#') {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Reads the "x:", "y:" or "z:" row of a piece
+std::vector<int> puzzleReader::readAxis(const std::string &expected) {
+	std::string line, keyword;
+	if (!nextLine(line)) {
+		fail("expected \"" + expected + "\" row before the end of the input");
+	}
+
+	std::istringstream fields(line);
+	fields >> keyword;
+	if (keyword != expected) {
+		fail("expected \"" + expected + "\" row");
+	}
+
+	std::vector<int> values;
+	int value;
+	while (fields >> value) {
+		// Elements hold each coordinate in a single byte
+		if (value < -64 || value > 63) {
+			fail("coordinates must lie between -64 and 63");
+		}
+		values.push_back(value);
+	}
+	if (!fields.eof()) {
+		fail("expected only integers after \"" + expected + "\"");
+	}
+	return values;
+}
+
+// Throws a std::runtime_error for the given line, by default the current one
+void puzzleReader::fail(const std::string &message, int line) const {
+	std::ostringstream error;
+	error << "Puzzle line " << (line > 0 ? line : lineNumber) << ": " << message;
+	throw std::runtime_error(error.str());
+}
+
+
+// Writes a puzzle in the format read by puzzleReader
+std::ostream &operator<< (std::ostream &os, const puzzleDefinition &puzzle) {
+	os << "Box: " << puzzle.box.get(0) << " " << puzzle.box.get(1) << " " << puzzle.box.get(2) << std::endl;
+	for (int i = 0; i < (int)puzzle.pieces.size(); ++i) {
+		os << puzzle.pieces[i];
+	}
+	os << "End" << std::endl;
+	return os;
+}
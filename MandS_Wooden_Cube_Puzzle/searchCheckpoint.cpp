@@ -0,0 +1,93 @@
+#include <cstdio> // remove(), rename()
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "searchCheckpoint.h"
+#include "recordIO.h"
+
+// Identifies the file format
+static const char *header = "cubeSolver checkpoint 1";
+
+searchCheckpoint::searchCheckpoint() {
+	fingerprint = 0;
+	complete = false;
+	depth = 0;
+	solved = false;
+	solutions = 0;
+	elapsedSeconds = 0;
+	firstSolutionSeconds = -1;
+}
+
+// Writes the checkpoint to a file by way of a temporary file, so that
+// being interrupted part way through leaves the previous checkpoint
+// intact. Returns false if the file cannot be written.
+bool searchCheckpoint::save(const std::string &file) const {
+	std::string temporary = file + ".tmp";
+	{
+		std::ofstream os(temporary.c_str());
+		os.precision(std::numeric_limits<double>::max_digits10);
+		os << header << std::endl;
+		os << "fingerprint " << fingerprint << std::endl;
+		os << "complete " << (complete ? 1 : 0) << std::endl;
+		os << "depth " << depth << std::endl;
+		writeList(os, "cursor", cursor);
+		writeList(os, "orientations", orientations);
+		os << "solved " << (solved ? 1 : 0) << std::endl;
+		writeList(os, "placed", placedMasks);
+		os << "solutions " << solutions << std::endl;
+		os << "elapsed " << elapsedSeconds << std::endl;
+		os << "first " << firstSolutionSeconds << std::endl;
+		stats.write(os);
+		if (!os) {
+			return false;
+		}
+	}
+
+	// rename() will not replace an existing file on Windows
+	std::remove(file.c_str());
+	return std::rename(temporary.c_str(), file.c_str()) == 0;
+}
+
+// Reads a checkpoint file, returning false if there is none.
+// Throws std::runtime_error if the file is malformed.
+bool searchCheckpoint::load(const std::string &file) {
+	std::ifstream is(file.c_str());
+	if (!is) {
+		return false;
+	}
+
+	std::string line;
+	if (!std::getline(is, line) || line != header) {
+		throw std::runtime_error("[" + file + "] is not a checkpoint");
+	}
+
+	try {
+		int flag;
+		readField(is, "fingerprint", fingerprint);
+		readField(is, "complete", flag);
+		complete = flag != 0;
+		readField(is, "depth", depth);
+		readList(is, "cursor", cursor);
+		readList(is, "orientations", orientations);
+		readField(is, "solved", flag);
+		solved = flag != 0;
+		readList(is, "placed", placedMasks);
+		readField(is, "solutions", solutions);
+		readField(is, "elapsed", elapsedSeconds);
+		readField(is, "first", firstSolutionSeconds);
+		if (!stats.read(is)) {
+			throw std::runtime_error("bad statistics");
+		}
+		if (depth < 0 || depth != (int)cursor.size()) {
+			throw std::runtime_error("the depth does not match the cursor");
+		}
+	}
+	catch (const std::runtime_error &error) {
+		throw std::runtime_error("Malformed checkpoint [" + file + "], " + error.what());
+	}
+	return true;
+}
@@ -0,0 +1,299 @@
+#include "searchKernels.h"
+#include "boxDimensions.h"
+
+// The SIMD overlap tests are only built for x86 processors. GCC and Clang
+// compile the AVX2 versions for that instruction set alone, so the rest of
+// the program still runs on processors without it. Builds with a wide
+// cellMask (see cellMask.h) have an AVX2 version alone.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define X86_KERNELS 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#else
+#define X86_KERNELS 0
+#endif
+
+
+// Returns the empty position (set within the mask) with the fewest
+// candidates, or -1 if no position is empty. Visits every position of an
+// X x Y x Z box so that the loop unrolls completely.
+template <int X, int Y, int Z>
+static int fixedMostConstrainedCell(cellMask empty, const int *candidates, const boxDimensions &) {
+	int best = -1, bestCount = 0;
+	for (int cell = 0; cell < X * Y * Z; ++cell) {
+		if (hasCell(empty, cell) && (best < 0 || candidates[cell] < bestCount)) {
+			best = cell;
+			bestCount = candidates[cell];
+		}
+	}
+	return best;
+}
+
+// Returns the empty position (set within the mask) with the fewest
+// candidates, or -1 if no position is empty. Visits only empty positions.
+static int runtimeMostConstrainedCell(cellMask empty, const int *candidates, const boxDimensions &) {
+	int best = -1;
+	for (; empty != 0; empty = withoutLowestCell(empty)) {
+		int cell = lowestCell(empty);
+		if (best < 0 || candidates[cell] < candidates[best]) {
+			best = cell;
+			if (candidates[best] == 0) {
+				break; // Cannot do any better
+			}
+		}
+	}
+	return best;
+}
+
+// A mask holding the positions of an X x Y x Z box at the given position
+// along the dir axis, evaluated at compile time
+template <int X, int Y, int Z>
+static constexpr cellMask fixedPlaneCells(int dir, int position) {
+	cellMask plane = 0;
+	for (int cell = 0; cell < X * Y * Z; ++cell) {
+		int at = dir == 0 ? cell % X : (dir == 1 ? (cell / X) % Y : cell / (X * Y));
+		if (at == position) {
+			plane |= cellBit(cell);
+		}
+	}
+	return plane;
+}
+
+// Grows the region through the empty positions of an X x Y x Z box. Each
+// pass moves the whole region one step along every axis at once, masking
+// off steps which would wrap around onto the next row or layer.
+template <int X, int Y, int Z>
+static cellMask fixedGrowRegion(cellMask region, cellMask empty, const boxDimensions &) {
+	constexpr cellMask notLowX = ~fixedPlaneCells<X, Y, Z>(0, 0);
+	constexpr cellMask notHighX = ~fixedPlaneCells<X, Y, Z>(0, X - 1);
+	constexpr cellMask notLowY = ~fixedPlaneCells<X, Y, Z>(1, 0);
+	constexpr cellMask notHighY = ~fixedPlaneCells<X, Y, Z>(1, Y - 1);
+
+	cellMask previous;
+	do {
+		previous = region;
+		region |= ((region << 1) & notLowX) | ((region >> 1) & notHighX)
+			| ((region << X) & notLowY) | ((region >> X) & notHighY)
+			| (region << (X * Y)) | (region >> (X * Y));
+		region &= empty;
+	} while (region != previous);
+	return region;
+}
+
+// Grows the region through the empty positions of a box of any size
+static cellMask runtimeGrowRegion(cellMask region, cellMask empty, const boxDimensions &box) {
+	int x = box.get(0), xy = box.get(0) * box.get(1);
+	cellMask notLowX = ~box.planeCells(0, 0);
+	cellMask notHighX = ~box.planeCells(0, box.get(0) - 1);
+	cellMask notLowY = ~box.planeCells(1, 0);
+	cellMask notHighY = ~box.planeCells(1, box.get(1) - 1);
+
+	cellMask previous;
+	do {
+		previous = region;
+		cellMask grown = ((previous << 1) & notLowX) | ((previous >> 1) & notHighX);
+		// Skip flat axes, a 64 position box may be a single row or layer
+		// and shifting a single word cellMask by 64 is undefined
+		if (box.get(1) > 1) {
+			grown |= ((previous << x) & notLowY) | ((previous >> x) & notHighY);
+		}
+		if (box.get(2) > 1) {
+			grown |= (previous << xy) | (previous >> xy);
+		}
+		region |= grown & empty;
+	} while (region != previous);
+	return region;
+}
+
+// Tests the masks one at a time
+static unsigned long long scalarFitMasks(const cellMask *masks, int count, cellMask grid) {
+	unsigned long long fits = 0;
+	for (int i = 0; i < count; ++i) {
+		if (!overlaps(masks[i], grid)) {
+			fits |= 1ULL << i;
+		}
+	}
+	return fits;
+}
+
+#if X86_KERNELS && MAX_BOX_CELLS <= 64
+
+// Tests two masks per instruction. SSE2 cannot compare 64-bit lanes, so
+// each lane is empty only when both of its 32-bit halves compare equal to 0.
+static unsigned long long sse2FitMasks(const cellMask *masks, int count, cellMask grid) {
+	const __m128i occupied = _mm_set1_epi64x((long long)grid);
+	const __m128i zero = _mm_setzero_si128();
+	unsigned long long fits = 0;
+
+	int i = 0;
+	for (; i + 2 <= count; i += 2) {
+		__m128i shared = _mm_and_si128(_mm_loadu_si128((const __m128i *)(masks + i)), occupied);
+		__m128i halves = _mm_cmpeq_epi32(shared, zero);
+		__m128i empty = _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+		fits |= (unsigned long long)_mm_movemask_pd(_mm_castsi128_pd(empty)) << i;
+	}
+	if (i < count && !overlaps(masks[i], grid)) {
+		fits |= 1ULL << i;
+	}
+	return fits;
+}
+
+// Tests four masks per instruction, eight per loop
+AVX2_TARGET
+static unsigned long long avx2FitMasks(const cellMask *masks, int count, cellMask grid) {
+	const __m256i occupied = _mm256_set1_epi64x((long long)grid);
+	const __m256i zero = _mm256_setzero_si256();
+	unsigned long long fits = 0;
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i low = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(masks + i)), occupied);
+		__m256i high = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(masks + i + 4)), occupied);
+		unsigned long long bits = (unsigned long long)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(low, zero)))
+			| ((unsigned long long)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(high, zero))) << 4);
+		fits |= bits << i;
+	}
+	for (; i < count; ++i) {
+		if (!overlaps(masks[i], grid)) {
+			fits |= 1ULL << i;
+		}
+	}
+	return fits;
+}
+
+#elif X86_KERNELS
+
+// Tests one wide mask at a time, a 128 or 256 position mask in one
+// instruction and a 512 position mask in two
+AVX2_TARGET
+static unsigned long long avx2FitMasks(const cellMask *masks, int count, cellMask grid) {
+	unsigned long long fits = 0;
+#if MAX_BOX_CELLS <= 128
+	const __m128i occupied = _mm_loadu_si128((const __m128i *)grid.words);
+	for (int i = 0; i < count; ++i) {
+		__m128i mask = _mm_loadu_si128((const __m128i *)masks[i].words);
+		fits |= (unsigned long long)_mm_testz_si128(mask, occupied) << i;
+	}
+#else
+	__m256i occupied[cellMaskWords / 4];
+	for (int part = 0; part < cellMaskWords / 4; ++part) {
+		occupied[part] = _mm256_loadu_si256((const __m256i *)(grid.words + 4 * part));
+	}
+	for (int i = 0; i < count; ++i) {
+		__m256i shared = _mm256_setzero_si256();
+		for (int part = 0; part < cellMaskWords / 4; ++part) {
+			__m256i mask = _mm256_loadu_si256((const __m256i *)(masks[i].words + 4 * part));
+			shared = _mm256_or_si256(shared, _mm256_and_si256(mask, occupied[part]));
+		}
+		fits |= (unsigned long long)_mm256_testz_si256(shared, shared) << i;
+	}
+#endif
+	return fits;
+}
+
+#endif
+
+#if X86_KERNELS
+
+// True if the processor and operating system support AVX2
+static bool supportsAvx2() {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	// The operating system must save the AVX registers (OSXSAVE and AVX)
+	if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif
+
+// The batch overlap test written for an instruction set, or null when
+// neither this build nor the processor supports it
+fitMasksFunction fitMasksFor(instructionSet instructions) {
+	if (instructions == scalarInstructions) {
+		return &scalarFitMasks;
+	}
+#if X86_KERNELS
+#if MAX_BOX_CELLS <= 64
+	if (instructions == sse2Instructions) {
+		return &sse2FitMasks;
+	}
+#endif
+	if (instructions == avx2Instructions && supportsAvx2()) {
+		return &avx2FitMasks;
+	}
+#endif
+	return 0;
+}
+
+// The name of an instruction set, e.g. "AVX2"
+const char *instructionSetName(instructionSet instructions) {
+	if (instructions == avx2Instructions) {
+		return "AVX2";
+	}
+	else if (instructions == sse2Instructions) {
+		return "SSE2";
+	}
+	else {
+		return "scalar";
+	}
+}
+
+// Uses the widest batch overlap test the processor supports
+static void selectFitMasks(searchKernels &kernels) {
+	instructionSet best[3] = { avx2Instructions, sse2Instructions, scalarInstructions };
+	for (int i = 0; i < 3; ++i) {
+		kernels.fitMasks = fitMasksFor(best[i]);
+		if (kernels.fitMasks != 0) {
+			kernels.fitMasksInstructions = best[i];
+			return;
+		}
+	}
+}
+
+// The kernels for an X x Y x Z box
+template <int X, int Y, int Z>
+static searchKernels fixedKernels() {
+	searchKernels kernels;
+	kernels.mostConstrainedCell = &fixedMostConstrainedCell<X, Y, Z>;
+	kernels.growRegion = &fixedGrowRegion<X, Y, Z>;
+	kernels.fixedSize = true;
+	selectFitMasks(kernels);
+	return kernels;
+}
+
+// Selects the kernels for a box
+searchKernels selectKernels(const boxDimensions &box) {
+	int x = box.get(0), y = box.get(1), z = box.get(2);
+
+	if (x == 2 && y == 2 && z == 2) { return fixedKernels<2, 2, 2>(); }
+	if (x == 3 && y == 3 && z == 3) { return fixedKernels<3, 3, 3>(); }
+	if (x == 4 && y == 4 && z == 4) { return fixedKernels<4, 4, 4>(); }
+	if (x == 2 && y == 3 && z == 4) { return fixedKernels<2, 3, 4>(); }
+	if (x == 2 && y == 2 && z == 4) { return fixedKernels<2, 2, 4>(); }
+	if (x == 3 && y == 3 && z == 4) { return fixedKernels<3, 3, 4>(); }
+#if MAX_BOX_CELLS >= 125
+	if (x == 5 && y == 5 && z == 5) { return fixedKernels<5, 5, 5>(); }
+#endif
+#if MAX_BOX_CELLS >= 216
+	if (x == 6 && y == 6 && z == 6) { return fixedKernels<6, 6, 6>(); }
+#endif
+
+	searchKernels kernels;
+	kernels.mostConstrainedCell = &runtimeMostConstrainedCell;
+	kernels.growRegion = &runtimeGrowRegion;
+	kernels.fixedSize = false;
+	selectFitMasks(kernels);
+	return kernels;
+}
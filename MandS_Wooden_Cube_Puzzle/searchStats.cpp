@@ -0,0 +1,162 @@
+#include <algorithm> // max()
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "searchStats.h"
+
+// Zero every counter, keeping room for the given number of depths
+void searchStats::reset(int noOfDepths) {
+	depthStats zero = { 0, 0, 0, 0, 0, 0, 0 };
+	depths.assign(noOfDepths, zero);
+}
+
+// Add the counters of another search, e.g. a parallel worker. The depths
+// below sharedDepths were walked alike by both, e.g. shards of one
+// search, so keep the larger of their counters instead of adding.
+void searchStats::merge(const searchStats &other, int sharedDepths) {
+	if (depths.size() < other.depths.size()) {
+		depthStats zero = { 0, 0, 0, 0, 0, 0, 0 };
+		depths.resize(other.depths.size(), zero);
+	}
+	for (int d = 0; d < (int)other.depths.size(); ++d) {
+		if (d < sharedDepths) {
+			depths[d].nodes = std::max(depths[d].nodes, other.depths[d].nodes);
+			depths[d].rejections = std::max(depths[d].rejections, other.depths[d].rejections);
+			depths[d].placements = std::max(depths[d].placements, other.depths[d].placements);
+			depths[d].prunes = std::max(depths[d].prunes, other.depths[d].prunes);
+			depths[d].backtracks = std::max(depths[d].backtracks, other.depths[d].backtracks);
+			depths[d].tableHits = std::max(depths[d].tableHits, other.depths[d].tableHits);
+			depths[d].tableMisses = std::max(depths[d].tableMisses, other.depths[d].tableMisses);
+			continue;
+		}
+		depths[d].nodes += other.depths[d].nodes;
+		depths[d].rejections += other.depths[d].rejections;
+		depths[d].placements += other.depths[d].placements;
+		depths[d].prunes += other.depths[d].prunes;
+		depths[d].backtracks += other.depths[d].backtracks;
+		depths[d].tableHits += other.depths[d].tableHits;
+		depths[d].tableMisses += other.depths[d].tableMisses;
+	}
+}
+
+// The number of depths counted
+int searchStats::noOfDepths() const {
+	return (int)depths.size();
+}
+
+long long int searchStats::totalNodes() const {
+	long long int total = 0;
+	for (int d = 0; d < (int)depths.size(); ++d) {
+		total += depths[d].nodes;
+	}
+	return total;
+}
+
+long long int searchStats::totalRejections() const {
+	long long int total = 0;
+	for (int d = 0; d < (int)depths.size(); ++d) {
+		total += depths[d].rejections;
+	}
+	return total;
+}
+
+long long int searchStats::totalPlacements() const {
+	long long int total = 0;
+	for (int d = 0; d < (int)depths.size(); ++d) {
+		total += depths[d].placements;
+	}
+	return total;
+}
+
+long long int searchStats::totalPrunes() const {
+	long long int total = 0;
+	for (int d = 0; d < (int)depths.size(); ++d) {
+		total += depths[d].prunes;
+	}
+	return total;
+}
+
+long long int searchStats::totalBacktracks() const {
+	long long int total = 0;
+	for (int d = 0; d < (int)depths.size(); ++d) {
+		total += depths[d].backtracks;
+	}
+	return total;
+}
+
+long long int searchStats::totalTableHits() const {
+	long long int total = 0;
+	for (int d = 0; d < (int)depths.size(); ++d) {
+		total += depths[d].tableHits;
+	}
+	return total;
+}
+
+long long int searchStats::totalTableMisses() const {
+	long long int total = 0;
+	for (int d = 0; d < (int)depths.size(); ++d) {
+		total += depths[d].tableMisses;
+	}
+	return total;
+}
+
+// Prints a single JSON line of progress after the given seconds
+void searchStats::printProgress(std::ostream &os, double seconds, long long int solutions) const {
+	long long int nodes = totalNodes();
+	os << "{\"event\":\"progress\",\"seconds\":" << seconds
+		<< ",\"nodes\":" << nodes
+		<< ",\"nodes_per_sec\":" << (seconds > 0 ? (double)nodes / seconds : 0)
+		<< ",\"rejections\":" << totalRejections()
+		<< ",\"prunes\":" << totalPrunes()
+		<< ",\"table_hits\":" << totalTableHits()
+		<< ",\"solutions\":" << solutions
+		<< ",\"nodes_per_depth\":[";
+	for (int d = 0; d < (int)depths.size(); ++d) {
+		os << (d == 0 ? "" : ",") << depths[d].nodes;
+	}
+	os << "]}" << std::endl;
+}
+
+// Prints one JSON line of counters per depth
+void searchStats::printDepths(std::ostream &os) const {
+	for (int d = 0; d < (int)depths.size(); ++d) {
+		os << "{\"event\":\"depth\",\"depth\":" << d
+			<< ",\"nodes\":" << depths[d].nodes
+			<< ",\"rejections\":" << depths[d].rejections
+			<< ",\"placements\":" << depths[d].placements
+			<< ",\"prunes\":" << depths[d].prunes
+			<< ",\"backtracks\":" << depths[d].backtracks
+			<< ",\"table_hits\":" << depths[d].tableHits
+			<< ",\"table_misses\":" << depths[d].tableMisses << "}" << std::endl;
+	}
+}
+
+// Saves and restores every counter, for checkpoints. read() returns
+// false if the stream does not hold what write() wrote.
+void searchStats::write(std::ostream &os) const {
+	os << "depths " << depths.size() << std::endl;
+	for (int d = 0; d < (int)depths.size(); ++d) {
+		os << depths[d].nodes << " " << depths[d].rejections << " " << depths[d].placements << " "
+			<< depths[d].prunes << " " << depths[d].backtracks << " "
+			<< depths[d].tableHits << " " << depths[d].tableMisses << std::endl;
+	}
+}
+
+bool searchStats::read(std::istream &is) {
+	std::string name;
+	int size;
+	if (!(is >> name >> size) || name != "depths" || size < 0) {
+		return false;
+	}
+
+	depthStats zero = { 0, 0, 0, 0, 0, 0, 0 };
+	depths.assign(size, zero);
+	for (int d = 0; d < size; ++d) {
+		if (!(is >> depths[d].nodes >> depths[d].rejections >> depths[d].placements
+			>> depths[d].prunes >> depths[d].backtracks >> depths[d].tableHits >> depths[d].tableMisses)) {
+			return false;
+		}
+	}
+	return true;
+}
\ No newline at end of file
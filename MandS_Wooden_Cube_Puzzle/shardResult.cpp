@@ -0,0 +1,126 @@
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "shardResult.h"
+#include "recordIO.h"
+
+// Identifies the file format
+static const char *header = "cubeSolver shard 1";
+
+shardResult::shardResult() {
+	index = 0;
+	count = 1;
+	fingerprint = 0;
+	solutions = 0;
+	elapsedSeconds = 0;
+	totalSeconds = 0;
+	firstSolutionSeconds = -1;
+	sharedDepths = 0;
+}
+
+// Writes the result to a file, returning false if it cannot be written
+bool shardResult::save(const std::string &file) const {
+	std::ofstream os(file.c_str());
+	os.precision(std::numeric_limits<double>::max_digits10);
+	os << header << std::endl;
+	os << "shard " << index << std::endl;
+	os << "of " << count << std::endl;
+	os << "fingerprint " << fingerprint << std::endl;
+	os << "box " << box.get(0) << " " << box.get(1) << " " << box.get(2) << std::endl;
+	writeList(os, "ids", ids);
+	os << "solutions " << solutions << std::endl;
+	os << "elapsed " << elapsedSeconds << std::endl;
+	os << "total " << totalSeconds << std::endl;
+	os << "first " << firstSolutionSeconds << std::endl;
+	os << "shared " << sharedDepths << std::endl;
+	stats.write(os);
+	os << "kept " << kept.size() << std::endl;
+	for (int i = 0; i < (int)kept.size(); ++i) {
+		writeList(os, "solution", kept[i]);
+	}
+	return !os.fail();
+}
+
+// Reads a result file. Throws std::runtime_error if the file cannot be
+// read or is malformed.
+void shardResult::load(const std::string &file) {
+	std::ifstream is(file.c_str());
+	if (!is) {
+		throw std::runtime_error("Cannot open [" + file + "]");
+	}
+
+	std::string line;
+	if (!std::getline(is, line) || line != header) {
+		throw std::runtime_error("[" + file + "] is not a shard result");
+	}
+
+	try {
+		int x, y, z;
+		readField(is, "shard", index);
+		readField(is, "of", count);
+		readField(is, "fingerprint", fingerprint);
+		readField(is, "box", x);
+		if (!(is >> y >> z)) {
+			throw std::runtime_error("short \"box\"");
+		}
+		try {
+			box = boxDimensions(x, y, z);
+		}
+		catch (const std::invalid_argument &error) {
+			throw std::runtime_error(error.what());
+		}
+		readList(is, "ids", ids);
+		readField(is, "solutions", solutions);
+		readField(is, "elapsed", elapsedSeconds);
+		readField(is, "total", totalSeconds);
+		readField(is, "first", firstSolutionSeconds);
+		readField(is, "shared", sharedDepths);
+		if (!stats.read(is)) {
+			throw std::runtime_error("bad statistics");
+		}
+
+		long long int noOfKept;
+		readField(is, "kept", noOfKept);
+		if (noOfKept < 0) {
+			throw std::runtime_error("bad size for \"kept\"");
+		}
+		// Kept grows with each solution read rather than by the count, which
+		// is only trusted as far as the lines following it bear it out
+		kept.clear();
+		for (long long int i = 0; i < noOfKept; ++i) {
+			std::vector<cellMask> solution;
+			readList(is, "solution", solution);
+			if (solution.size() != ids.size()) {
+				throw std::runtime_error("a solution does not match the pieces");
+			}
+			kept.push_back(solution);
+		}
+		if (count < 1 || index < 0 || index >= count) {
+			throw std::runtime_error("bad shard index");
+		}
+	}
+	catch (const std::runtime_error &error) {
+		throw std::runtime_error("Malformed shard result [" + file + "], " + error.what());
+	}
+}
+
+// Adds another shard of the same search. Throws std::runtime_error if
+// it belongs to another search.
+void shardResult::merge(const shardResult &other) {
+	if (other.fingerprint != fingerprint || other.count != count || other.sharedDepths != sharedDepths) {
+		throw std::runtime_error("Shard [" + std::to_string(other.index) + "] belongs to another search");
+	}
+
+	solutions += other.solutions;
+	elapsedSeconds = other.elapsedSeconds > elapsedSeconds ? other.elapsedSeconds : elapsedSeconds;
+	totalSeconds += other.totalSeconds;
+	if (other.firstSolutionSeconds >= 0 && (firstSolutionSeconds < 0 || other.firstSolutionSeconds < firstSolutionSeconds)) {
+		firstSolutionSeconds = other.firstSolutionSeconds;
+	}
+	stats.merge(other.stats, sharedDepths);
+	kept.insert(kept.end(), other.kept.begin(), other.kept.end());
+}
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include <vector>
+#include "solutionIterator.h"
+
+
+// Constructor taking in the solver, with every piece added, to search
+solutionIterator::solutionIterator(const cubeSolver &toSearch)
+	: solver(toSearch), started(false), exhausted(false), holding(false), visited(0) {
+	solver.setSearchMode(cubeSolver::interleavedSearch);
+	balanced = solver.prepareSearch();
+	indices.assign(solver.wrappedPieces.size(), -1);
+	// Frames are referred to whilst deeper ones are pushed
+	stack.reserve(solver.wrappedPieces.size());
+}
+
+// Searches on to the next solution, returning true once one is held.
+// Returns false once the search is exhausted or, if nodeBudget is not
+// negative, after visiting that many nodes without finding one. A later
+// call then carries on from where this one stopped.
+bool solutionIterator::advance(long long int nodeBudget) {
+	if (exhausted) {
+		return false;
+	}
+
+	int pieces = (int)solver.wrappedPieces.size();
+	visited = 0;
+	if (!started) {
+		started = true;
+		if (!balanced || pieces == 0) {
+			exhausted = true;
+			return false;
+		}
+		enter(0);
+	}
+	else if (holding) {
+		// Take the last piece of the previous solution back off
+		holding = false;
+		solver.removePiece(pieces - 1);
+		solver.stats.backtrack(pieces - 1);
+	}
+
+	// The same steps as cubeSolver::interleavedSolver(), with the loop
+	// position of each level kept in its frame instead of on the call stack
+	while (nodeBudget < 0 || visited < nodeBudget) {
+		int level = (int)stack.size() - 1;
+		frame &top = stack.back();
+		int last = solver.placements.noOfPlacements(level);
+		const cellMask *masks = solver.placements.getMasks(level);
+
+		// Test the next block of up to 64 placements once this one is used up
+		while (top.fits == 0 && top.block + 64 < last) {
+			top.block += 64;
+			int size = last - top.block < 64 ? last - top.block : 64;
+			top.fits = solver.kernels.fitMasks(masks + top.block, size, solver.grid);
+			solver.stats.rejection(level, size - cellCount(top.fits));
+		}
+
+		// Every placement was tried, back up to the level above
+		if (top.fits == 0) {
+			stack.pop_back();
+			if (stack.empty()) {
+				exhausted = true;
+				return false;
+			}
+			solver.removePiece(level - 1);
+			solver.stats.backtrack(level - 1);
+			continue;
+		}
+
+		int index = top.block + lowestCell(top.fits);
+		top.fits &= top.fits - 1;
+		solver.placePiece(level, masks[index]);
+		indices[level] = index;
+		solver.stats.placement(level);
+
+		if (level + 1 == pieces) {
+			// A rotated copy of a solution already returned or yet to come
+			if (solver.symmetryBreaking && !solver.leastRotatedCopy()) {
+				solver.removePiece(level);
+				solver.stats.backtrack(level);
+				continue;
+			}
+			solver.solutionCount++;
+			holding = true;
+			return true;
+		}
+
+		if ((solver.pruneColours && !solver.coloursReachable(level, index, top.needed))
+			|| (solver.pruneRegions && !solver.regionsFillable(solver.fillableSizes[level + 1]))) {
+			solver.removePiece(level);
+			solver.stats.prune(level);
+			continue;
+		}
+
+		enter(level + 1);
+	}
+	return false;
+}
+
+// Starts searching the placements of the piece at the given level
+void solutionIterator::enter(int level) {
+	frame next;
+	// The first block is tested on the way into the loop of advance()
+	next.block = -64;
+	next.fits = 0;
+	if (solver.pruneColours) {
+		solver.neededColours(next.needed);
+	}
+	stack.push_back(next);
+	solver.stats.node(level);
+	++visited;
+}
+
+// True once every solution has been handed back
+bool solutionIterator::isExhausted() const {
+	return exhausted;
+}
+
+// The index of each piece's placement in the solution held, counting
+// the placements of that piece in the order the placement table holds them
+const std::vector<int> &solutionIterator::getPlacementIndices() const {
+	return indices;
+}
+
+// The mask each piece occupies in the solution held
+const std::vector<cellMask> &solutionIterator::getPlacedMasks() const {
+	return solver.placedMasks;
+}
+
+// The orientation (0 to 23) and location of a piece in the solution held
+int solutionIterator::getOrientation(int p) const {
+	return solver.placements.getOrientation(p, indices[p]);
+}
+
+int solutionIterator::getLocation(int p) const {
+	return solver.placements.getLocation(p, indices[p]);
+}
+
+// The number of solutions handed back so far
+long long int solutionIterator::noOfSolutions() const {
+	return solver.noOfSolutions();
+}
+
+// The number of nodes visited so far
+long long int solutionIterator::noOfIterations() const {
+	return solver.noOfIterations();
+}
+
+// Prints the solution held in the same layout as cubeSolver
+std::ostream &operator<< (std::ostream &os, const solutionIterator &solutions) {
+	return os << solutions.solver;
+}
\ No newline at end of file
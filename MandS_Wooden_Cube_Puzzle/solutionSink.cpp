@@ -0,0 +1,24 @@
+#include <iostream>
+#include <vector>
+#include "solutionSink.h"
+#include "placementTable.h"
+
+
+streamSink::streamSink(std::ostream &out) : os(out), count(0) {}
+
+void streamSink::addSolution(const boxDimensions &box, const std::vector<cellMask> &placedMasks, const std::vector<wrappedPiece> &wrappedPieces) {
+	++count;
+	os << "Solution [" << count << "]" << std::endl;
+	placementTable::printGrid(os, box, placedMasks, wrappedPieces);
+	os << std::endl;
+}
+
+
+void collectingSink::addSolution(const boxDimensions &, const std::vector<cellMask> &placedMasks, const std::vector<wrappedPiece> &) {
+	solutions.push_back(placedMasks);
+}
+
+// The solutions received, in order of arrival
+const std::vector<std::vector<cellMask> > &collectingSink::getSolutions() const {
+	return solutions;
+}
\ No newline at end of file
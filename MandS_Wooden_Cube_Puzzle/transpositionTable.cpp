@@ -0,0 +1,76 @@
+#include <atomic>
+#include <memory>
+
+#include "transpositionTable.h"
+
+// Constructor taking in log2 of the number of slots and the policy
+transpositionTable::transpositionTable(int bits, replacementPolicy toUse) {
+	configure(bits, toUse);
+	allocatedBits = 0;
+}
+
+// Copies only the size and policy, never the states held
+transpositionTable::transpositionTable(const transpositionTable &other) {
+	configure(other.sizeBits, other.policy);
+	allocatedBits = 0;
+}
+
+transpositionTable& transpositionTable::operator=(const transpositionTable &other) {
+	configure(other.sizeBits, other.policy);
+	return *this;
+}
+
+// Change the size and policy, taking effect at the next clear()
+transpositionTable& transpositionTable::configure(int bits, replacementPolicy toUse) {
+	sizeBits = bits < 1 ? 1 : (bits > 32 ? 32 : bits);
+	policy = toUse;
+	return *this;
+}
+
+// Forget every state, allocating the slots on first use
+void transpositionTable::clear() {
+	if (allocatedBits != sizeBits) {
+		slots.reset(new std::atomic<unsigned long long>[slotWords * noOfSlots()]);
+		allocatedBits = sizeBits;
+	}
+	for (long long int slot = 0; slot < slotWords * noOfSlots(); ++slot) {
+		slots[slot].store(0, std::memory_order_relaxed);
+	}
+}
+
+// The number of slots and how many currently hold a state
+long long int transpositionTable::noOfSlots() const {
+	return 1LL << sizeBits;
+}
+
+long long int transpositionTable::noOfUsedSlots() const {
+	long long int used = 0;
+	if (allocatedBits == sizeBits) {
+		for (long long int slot = 0; slot < noOfSlots(); ++slot) {
+			if (slots[slotWords * slot + cellMaskWords].load(std::memory_order_relaxed) != 0) {
+				used++;
+			}
+		}
+	}
+	return used;
+}
+
+// Records a state as having no completion, subject to the policy
+void transpositionTable::insert(const cellMask &occupied, unsigned long long remaining) {
+	unsigned long long hash = hashOf(occupied, remaining);
+	std::atomic<unsigned long long> *slot = &slots[slotWords * indexOf(hash)];
+	unsigned long long depth = (unsigned long long)cellCount(remaining);
+
+	if (policy == replaceShallower) {
+		unsigned long long held = slot[cellMaskWords].load(std::memory_order_relaxed);
+		if (held != 0 && (held >> maxPieces) > depth) {
+			return; // Keep the more expensive state
+		}
+	}
+
+	unsigned long long data = (depth << maxPieces) | remaining;
+	for (int word = 0; word < cellMaskWords; ++word) {
+		slot[word].store(maskWord(occupied, word) ^ data ^ hash, std::memory_order_relaxed);
+	}
+	slot[cellMaskWords].store(data, std::memory_order_relaxed);
+}
@@ -0,0 +1,67 @@
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "workStealingPool.h"
+
+
+// Constructor taking in the number of worker threads
+workStealingPool::workStealingPool(int threads) : queues(threads < 1 ? 1 : threads), nextQueue(0) {}
+
+int workStealingPool::noOfThreads() const {
+	return (int)queues.size();
+}
+
+// Queue a task, spreading tasks evenly over the workers
+void workStealingPool::submit(const std::function<void(int)> &task) {
+	std::lock_guard<std::mutex> guard(queues[nextQueue].lock);
+	queues[nextQueue].tasks.push_back(task);
+	nextQueue = (nextQueue + 1) % noOfThreads();
+}
+
+// Runs every submitted task, blocking until all have completed
+void workStealingPool::run() {
+	std::vector<std::thread> workers;
+	for (int worker = 1; worker < noOfThreads(); ++worker) {
+		workers.push_back(std::thread(&workStealingPool::workerLoop, this, worker));
+	}
+
+	// The calling thread acts as worker 0
+	workerLoop(0);
+
+	for (int i = 0; i < (int)workers.size(); ++i) {
+		workers[i].join();
+	}
+}
+
+// Runs tasks for a single worker until no queue holds any more
+void workStealingPool::workerLoop(int worker) {
+	std::function<void(int)> task;
+	while (takeTask(worker, task)) {
+		task(worker);
+	}
+}
+
+// Takes a task from the worker's own queue, or failing that steals
+// one from another worker. Returns false once every queue is empty.
+bool workStealingPool::takeTask(int worker, std::function<void(int)> &task) {
+	{
+		std::lock_guard<std::mutex> guard(queues[worker].lock);
+		if (!queues[worker].tasks.empty()) {
+			task = queues[worker].tasks.back();
+			queues[worker].tasks.pop_back();
+			return true;
+		}
+	}
+
+	for (int offset = 1; offset < noOfThreads(); ++offset) {
+		taskQueue &victim = queues[(worker + offset) % noOfThreads()];
+		std::lock_guard<std::mutex> guard(victim.lock);
+		if (!victim.tasks.empty()) {
+			task = victim.tasks.front();
+			victim.tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
@@ -1,37 +1,92 @@
 #include <iostream>
 #include <vector>
+#include <algorithm> // sort()
 #include "wrappedPiece.h"
 #include "element.h"
 #include "piece.h"
 
 
-// Constructor taking in toWrap which is the originalPiece
-// We also setup our rotation matrices: rotmatx, rotmaty and rotmatz.
-wrappedPiece::wrappedPiece(const piece &toWrap) : originalPiece(toWrap), orientatedPiece(toWrap), locatedPiece(toWrap) {
-	std::vector<int> row1, row2, row3;
-	row1.push_back(1); row1.push_back(0); row1.push_back(0);
-	row2.push_back(0); row2.push_back(0); row2.push_back(-1);
-	row3.push_back(0); row3.push_back(1); row3.push_back(0);
-	rotmatx.push_back(row1);
-	rotmatx.push_back(row2);
-	rotmatx.push_back(row3);
-
-	row1.clear(); row2.clear(); row3.clear();
-	row1.push_back(0); row1.push_back(0); row1.push_back(1);
-	row2.push_back(0); row2.push_back(1); row2.push_back(0);
-	row3.push_back(-1); row3.push_back(0); row3.push_back(0);
-	rotmaty.push_back(row1);
-	rotmaty.push_back(row2);
-	rotmaty.push_back(row3);
-
-	row1.clear(); row2.clear(); row3.clear();
-	row1.push_back(0); row1.push_back(-1); row1.push_back(0);
-	row2.push_back(1); row2.push_back(0); row2.push_back(0);
-	row3.push_back(0); row3.push_back(0); row3.push_back(1);
-	rotmatz.push_back(row1);
-	rotmatz.push_back(row2);
-	rotmatz.push_back(row3);
+// A rotation of the cube as a signed permutation of the axes: the rotated
+// position along axis i is sign[i] times the original along axis[i].
+struct axisRotation {
+	int axis[3];
+	int sign[3];
+};
 
+// Quarter turns about the x, y and z axis. As matrices these are
+// rotmatx = { {1,0,0}, {0,0,-1}, {0,1,0} }, rotmaty = { {0,0,1}, {0,1,0}, {-1,0,0} }
+// and rotmatz = { {0,-1,0}, {1,0,0}, {0,0,1} }.
+static constexpr axisRotation quarterTurns[3] = {
+	{ { 0, 2, 1 }, { 1, -1, 1 } },
+	{ { 2, 1, 0 }, { 1, 1, -1 } },
+	{ { 1, 0, 2 }, { -1, 1, 1 } }
+};
+
+// Applies rotation first then another rotation
+static constexpr axisRotation compose(const axisRotation &first, const axisRotation &then) {
+	return axisRotation{
+		{ first.axis[then.axis[0]], first.axis[then.axis[1]], first.axis[then.axis[2]] },
+		{ then.sign[0] * first.sign[then.axis[0]], then.sign[1] * first.sign[then.axis[1]], then.sign[2] * first.sign[then.axis[2]] }
+	};
+}
+
+// Applies a rotation and then quarter turns about the dir axis
+static constexpr axisRotation turn(axisRotation rotation, int dir, int howManyTimes) {
+	for (int count = 0; count < howManyTimes; ++count) {
+		rotation = compose(rotation, quarterTurns[dir]);
+	}
+	return rotation;
+}
+
+// Works out the rotation of an orientation (0 to 23). First the piece is
+// turned to point in the intended direction, then rotated about that
+// direction. See wrappedPiece::orientatePiece().
+static constexpr axisRotation makeRotation(int orientation) {
+	int rotations = orientation % 4;
+	int direction = orientation / 4;
+	axisRotation identity = { { 0, 1, 2 }, { 1, 1, 1 } };
+
+	if (direction == 0) {
+		// Already in the correct direction
+		return turn(identity, 0, rotations);
+	}
+	else if (direction == 1) {
+		return turn(turn(identity, 1, 1), 2, rotations);
+	}
+	else if (direction == 2) {
+		return turn(turn(identity, 1, 2), 0, rotations);
+	}
+	else if (direction == 3) {
+		return turn(turn(identity, 1, 3), 2, rotations);
+	}
+	else if (direction == 4) {
+		return turn(turn(identity, 2, 1), 1, rotations);
+	}
+	else {
+		return turn(turn(identity, 2, 3), 1, rotations);
+	}
+}
+
+// All 24 rotations, indexed by orientation
+struct rotationTable {
+	axisRotation rotations[24];
+};
+
+static constexpr rotationTable makeRotationTable() {
+	rotationTable table = {};
+	for (int orientation = 0; orientation < 24; ++orientation) {
+		table.rotations[orientation] = makeRotation(orientation);
+	}
+	return table;
+}
+
+static constexpr rotationTable orientationRotations = makeRotationTable();
+
+
+// Constructor taking in toWrap which is the originalPiece and the box it must stay within.
+wrappedPiece::wrappedPiece(const piece &toWrap, const boxDimensions &dimensions) : originalPiece(toWrap),
+	orientatedPiece(toWrap), locatedPiece(toWrap), box(dimensions) {
+	findDistinctOrientations();
 	updateAvailableLocations();
 }
 
@@ -39,8 +94,32 @@ int wrappedPiece::getId() const {
 	return originalPiece.getId();
 }
 
+// The number of elements making up the piece
+int wrappedPiece::size() const {
+	return originalPiece.size();
+}
+
 int wrappedPiece::noOfLocations() {
-	return (int)locations.size();
+	int count = 1;
+	for (int dir = 0; dir < 3; ++dir) {
+		count *= maxShifts[dir] < 0 ? 0 : maxShifts[dir] + 1;
+	}
+	return count;
+}
+
+// The number of orientations producing a distinct shape
+int wrappedPiece::noOfOrientations() const {
+	return noOfDistinctOrientations;
+}
+
+// Returns the i-th distinct orientation, in the range 0 to 23
+int wrappedPiece::getOrientation(int i) const {
+	return distinctOrientations[i];
+}
+
+// The number of orientations discarded as duplicates of another
+int wrappedPiece::noOfDuplicateOrientations() const {
+	return 24 - noOfOrientations();
 }
 
 void wrappedPiece::printOrientatedPiece(std::ostream &os) const {
@@ -60,58 +139,42 @@ void wrappedPiece::printLocatedPiece(std::ostream &os) const {
 // of the L can be made to point up, down, left or right. (Think of the four sides
 // to a square. This gives a total of 6 x 4 = 24 possibilities.  
 piece& wrappedPiece::orientatePiece(int orientation) {
-	orientatedPiece = originalPiece;
-
-	int rotations, direction;
-
-	// Work out the intended direction and rotation
-	rotations = orientation % 4;
-	direction = (orientation - rotations) / 4;
-
-	// First set the piece in the intended direction,
-	// then perform the necessary rotations
-	if (direction == 0) {
-		// Already in the correct direction
-		rotatePiece(dirx, rotations);
-	}
-	else if (direction == 1) {
-		rotatePiece(diry, 1);
-		rotatePiece(dirz, rotations);
-	}
-	else if (direction == 2) {
-		rotatePiece(diry, 2);
-		rotatePiece(dirx, rotations);
-	}
-	else if (direction == 3) {
-		rotatePiece(diry, 3);
-		rotatePiece(dirz, rotations);
-	}
-	else if (direction == 4) {
-		rotatePiece(dirz, 1);
-		rotatePiece(diry, rotations);
-	}
-	else {
-		rotatePiece(dirz, 3);
-		rotatePiece(diry, rotations);
-	}
-
-	startAtOrigin();
+	applyOrientation(orientation);
 	updateAvailableLocations();
 	return orientatedPiece;
 }
 
+// Applies the rotations of an orientation (0 to 23) to a single element
+// about the origin, without moving the result back to the origin.
+element wrappedPiece::orientateElement(int orientation, const element &toOrientate) {
+	const axisRotation &rotation = orientationRotations.rotations[orientation];
+	return element(rotation.sign[0] * toOrientate.get(rotation.axis[0]),
+		rotation.sign[1] * toOrientate.get(rotation.axis[1]),
+		rotation.sign[2] * toOrientate.get(rotation.axis[2]));
+}
+
 // This shifts intermediate orientatedPiece to produce final output locatedPiece.
-// Argument location should be within the range 0 to locations.size().
+// Argument location should be within the range 0 to noOfLocations().
 piece& wrappedPiece::relocatePiece(int location) {
 	locatedPiece = orientatedPiece;
 
-	locatedPiece.shift(0, locations[location].get(0));
-	locatedPiece.shift(1, locations[location].get(1));
-	locatedPiece.shift(2, locations[location].get(2));
+	int ySpan = maxShifts[1] + 1, zSpan = maxShifts[2] + 1;
+	locatedPiece.shift(0, location / (ySpan * zSpan));
+	locatedPiece.shift(1, location / zSpan % ySpan);
+	locatedPiece.shift(2, location % zSpan);
 
 	return locatedPiece;
 }
 
+// Sets orientatedPiece to the originalPiece in an orientation (0 to 23),
+// moved back to the origin, leaving the locations untouched
+void wrappedPiece::applyOrientation(int orientation) {
+	for (int i = 0; i < orientatedPiece.size(); ++i) {
+		orientatedPiece.updateElement(i) = orientateElement(orientation, originalPiece.getElement(i));
+	}
+	startAtOrigin();
+}
+
 // Returns the lowest occupied position by the orientatedPiece
 // along the dir axis
 int wrappedPiece::getMinPosition(int dir) const {
@@ -134,7 +197,7 @@ int wrappedPiece::getMaxPosition(int dir) const {
 	return max;
 }
 
-// After rotatePiece() has been called it may nolonger start at the origin.
+// After the piece has been rotated it may nolonger start at the origin.
 // This relocated the piece to start at the origin, ie. the minimum position 
 // occupied by the piece along all 3 major axis is 0. In particular this
 // ensure that the rotated piece remains inside the cube.
@@ -147,41 +210,58 @@ void wrappedPiece::startAtOrigin() {
 	}
 }
 
-// Rotate an element using matrix multiplications with a rotation matrix.
-void wrappedPiece::rotateElement(const std::vector<std::vector<int> > &matrot, element &toRotate) {
-	int x = 0, y = 0, z = 0;
-
-	// Matrix multiplication
-	for (int i = 0; i < 3; ++i) {
-		x += matrot[0][i] * toRotate.get(i);
-		y += matrot[1][i] * toRotate.get(i);
-		z += matrot[2][i] * toRotate.get(i);
+// Writes the elements of orientatedPiece sorted and packed into integers,
+// one per element. Two orientations produce the same shape exactly when
+// these are equal.
+void wrappedPiece::canonicalOrientation(int *packed) const {
+	// After startAtOrigin() every coordinate lies in [0, max + 1). The
+	// element count is not a bound: a long or disconnected piece can
+	// reach further than it has elements.
+	int base = 1;
+	for (int dir = 0; dir < 3; ++dir) {
+		if (getMaxPosition(dir) + 1 > base) { base = getMaxPosition(dir) + 1; }
 	}
 
-	toRotate.update(0, x);
-	toRotate.update(1, y);
-	toRotate.update(2, z);
+	for (int i = 0; i < orientatedPiece.size(); ++i) {
+		element elem = orientatedPiece.getElement(i);
+		packed[i] = elem.get(0) + base * (elem.get(1) + base * elem.get(2));
+	}
+	std::sort(packed, packed + orientatedPiece.size());
 }
 
-// Rotate a piece by rotating each element in turn.
-void wrappedPiece::rotatePiece(direction dir, int howManyTimes) {
-	if (howManyTimes == 0) {
-		return;
-	}
+// Fills distinctOrientations by hashing the canonical form of all 24 orientations
+void wrappedPiece::findDistinctOrientations() {
+	// Kept on the stack, one entry per distinct orientation so far
+	unsigned long long hashes[24];
+	int shapes[24][piece::maxElements];
+	int size = originalPiece.size();
 
-	for (int count = 0; count < howManyTimes; ++count) {
-		for (int i = 0; i < orientatedPiece.size(); ++i) {
-			if (dir == dirx) {
-				rotateElement(rotmatx, orientatedPiece.updateElement(i));
-			}
-			else if (dir == diry) {
-				rotateElement(rotmaty, orientatedPiece.updateElement(i));
-			}
-			else {
-				rotateElement(rotmatz, orientatedPiece.updateElement(i));
-			}
+	noOfDistinctOrientations = 0;
+	for (int orientation = 0; orientation < 24; ++orientation) {
+		applyOrientation(orientation);
+		int *shape = shapes[noOfDistinctOrientations];
+		canonicalOrientation(shape);
+
+		// FNV-1a over the packed elements
+		unsigned long long hash = 14695981039346656037ULL;
+		for (int i = 0; i < size; ++i) {
+			hash ^= (unsigned long long)shape[i];
+			hash *= 1099511628211ULL;
+		}
+
+		// Only compare full shapes when the hashes collide
+		bool duplicate = false;
+		for (int i = 0; i < noOfDistinctOrientations && !duplicate; ++i) {
+			duplicate = hashes[i] == hash && std::equal(shape, shape + size, shapes[i]);
+		}
+
+		if (!duplicate) {
+			hashes[noOfDistinctOrientations] = hash;
+			distinctOrientations[noOfDistinctOrientations++] = orientation;
 		}
 	}
+
+	orientatedPiece = originalPiece;
 }
 
 // After a piece has been orientated we recalculate how it can be
@@ -189,20 +269,8 @@ void wrappedPiece::rotatePiece(direction dir, int howManyTimes) {
 // shifts/locations won't change, but what each possible location
 // is will change. 
 void wrappedPiece::updateAvailableLocations() {
-	locations.clear();
-
-	int maxxshift, maxyshift, maxzshift;
-
-	maxxshift = (SIZE - 1) - getMaxPosition(0);
-	maxyshift = (SIZE - 1) - getMaxPosition(1);
-	maxzshift = (SIZE - 1) - getMaxPosition(2);
-
-	for (int i = 0; i <= maxxshift; ++i) {
-		for (int j = 0; j <= maxyshift; ++j) {
-			for (int k = 0; k <= maxzshift; ++k) {
-				locations.push_back(element(i, j, k));
-			}
-		}
+	for (int dir = 0; dir < 3; ++dir) {
+		maxShifts[dir] = (box.get(dir) - 1) - getMaxPosition(dir);
 	}
 }
 